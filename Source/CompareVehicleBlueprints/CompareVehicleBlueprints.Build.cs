@@ -38,6 +38,7 @@ public class CompareVehicleBlueprints : ModuleRules
 				"Projects",
 				"InputCore",
 				"EditorFramework",
+				"EditorSubsystem",
 				"UnrealEd",
 				"ToolMenus",
 				"CoreUObject",
@@ -53,9 +54,12 @@ public class CompareVehicleBlueprints : ModuleRules
                 "CommonInput",
                 "EnhancedInput",
                 "PythonScriptPlugin",
-                "SubobjectDataInterface",
                 "ChaosVehicles",
-				"PropertyEditor"
+				"PropertyEditor",
+				"Json",
+				"DeveloperSettings",
+				"AssetRegistry",
+				"ContentBrowser"
 
 				// ... add private dependencies that you statically link with here ...	
 			}
@@ -0,0 +1,384 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "BlueprintGraphComparer.h"
+#include "Engine/Blueprint.h"
+#include "EdGraph/EdGraph.h"
+#include "EdGraph/EdGraphNode.h"
+#include "EdGraph/EdGraphPin.h"
+#include "EdGraphSchema_K2.h"
+
+namespace
+{
+	// pins are matched by name within a node, inputs and outputs can share a name
+	using FPinKey = TPair<FName, EEdGraphPinDirection>;
+
+	// a connection as seen from side B, the node on the other end and its pin
+	using FLinkKey = TPair<const UEdGraphNode*, FName>;
+
+	FPinKey MakePinKey(const UEdGraphPin* Pin)
+	{
+		return FPinKey(Pin->PinName, Pin->Direction.GetValue());
+	}
+
+	// a title and a cell of the grid below
+	using FTitleCell = TPair<int32, FIntPoint>;
+
+	// nodes within about this distance of each other are found without looking further, in graph units
+	constexpr int32 CellSize = 512;
+
+	FIntPoint GetCell(const UEdGraphNode* Node)
+	{
+		return FIntPoint(FMath::DivideAndRoundDown(Node->NodePosX, CellSize), FMath::DivideAndRoundDown(Node->NodePosY, CellSize));
+	}
+
+	// nodes recreated from the same action have the same class and title
+	FString MakeTitleKey(const UEdGraphNode* Node)
+	{
+		return Node->GetClass()->GetName() + ":" + Node->GetNodeTitle(ENodeTitleType::ListView).ToString();
+	}
+
+}
+
+void FBlueprintGraphComparer::Compare(const FString& PathA, const FString& PathB, const UBlueprint* A, const UBlueprint* B)
+{
+	if (!A || !B)
+	{
+		return;
+	}
+
+	TArray<UEdGraph*> GraphsA;
+	TArray<UEdGraph*> GraphsB;
+	A->GetAllGraphs(GraphsA);
+	B->GetAllGraphs(GraphsB);
+
+	// graphs are matched by name, event graphs, functions and macros each have their own
+	TMap<FName, const UEdGraph*> GraphsByNameB;
+	for (const UEdGraph* Graph : GraphsB)
+	{
+		GraphsByNameB.Add(Graph->GetFName(), Graph);
+	}
+
+	for (const UEdGraph* GraphA : GraphsA)
+	{
+		const UEdGraph* GraphB = nullptr;
+		if (!GraphsByNameB.RemoveAndCopyValue(GraphA->GetFName(), GraphB))
+		{
+			AddMessage("Graph " + GraphA->GetName() + " is only in " + PathA, EDifferenceType::Warning);
+			continue;
+		}
+
+		CompareGraphs(PathA + "/" + GraphA->GetName(), PathB + "/" + GraphB->GetName(), GraphA, GraphB);
+	}
+
+	for (const TPair<FName, const UEdGraph*>& Pair : GraphsByNameB)
+	{
+		AddMessage("Graph " + Pair.Value->GetName() + " is only in " + PathB, EDifferenceType::Warning);
+	}
+}
+
+void FBlueprintGraphComparer::MatchNodes(const UEdGraph* A, const UEdGraph* B, TMap<const UEdGraphNode*, const UEdGraphNode*>& OutMatches) const
+{
+	// first by guid, which survives moving and editing a node
+	TMap<FGuid, const UEdGraphNode*> NodesByGuidB;
+	NodesByGuidB.Reserve(B->Nodes.Num());
+	for (const UEdGraphNode* Node : B->Nodes)
+	{
+		if (Node)
+		{
+			NodesByGuidB.Add(Node->NodeGuid, Node);
+		}
+	}
+
+	TSet<const UEdGraphNode*> MatchedB;
+	TArray<const UEdGraphNode*> UnmatchedA;
+
+	for (const UEdGraphNode* Node : A->Nodes)
+	{
+		if (!Node)
+		{
+			continue;
+		}
+
+		const UEdGraphNode* const* Match = NodesByGuidB.Find(Node->NodeGuid);
+		if (Match && !MatchedB.Contains(*Match))
+		{
+			OutMatches.Add(Node, *Match);
+			MatchedB.Add(*Match);
+		}
+		else
+		{
+			UnmatchedA.Add(Node);
+		}
+	}
+
+	if (UnmatchedA.Num() == 0)
+	{
+		return;
+	}
+
+	// then nodes which were deleted and recreated, by class and title, the nearest one if several share a title.
+	// Candidates are bucketed by title and a coarse grid cell, so a node only looks at the candidates around it
+	// however many nodes share its title
+	TMap<FString, int32> TitleIds;
+	TMap<FTitleCell, TArray<const UEdGraphNode*>> NodesByCellB;
+
+	// every candidate of a title, for a node with none nearby. Taken from the end, matched ones are skipped
+	TArray<TArray<const UEdGraphNode*>> NodesByTitleB;
+
+	for (const UEdGraphNode* Node : B->Nodes)
+	{
+		if (Node && !MatchedB.Contains(Node))
+		{
+			const FString TitleKey = MakeTitleKey(Node);
+			const int32* ExistingId = TitleIds.Find(TitleKey);
+			const int32 TitleId = ExistingId ? *ExistingId : TitleIds.Add(TitleKey, NodesByTitleB.AddDefaulted());
+
+			NodesByCellB.FindOrAdd(FTitleCell(TitleId, GetCell(Node))).Add(Node);
+			NodesByTitleB[TitleId].Add(Node);
+		}
+	}
+
+	for (const UEdGraphNode* Node : UnmatchedA)
+	{
+		const int32* TitleId = TitleIds.Find(MakeTitleKey(Node));
+		if (!TitleId)
+		{
+			continue;
+		}
+
+		// the nearest unmatched candidate in the node's cell and the eight around it
+		const FIntPoint Cell = GetCell(Node);
+		TArray<const UEdGraphNode*>* NearestCell = nullptr;
+		int32 Nearest = INDEX_NONE;
+		int64 NearestDistance = MAX_int64;
+
+		for (int32 Y = Cell.Y - 1; Y <= Cell.Y + 1; ++Y)
+		{
+			for (int32 X = Cell.X - 1; X <= Cell.X + 1; ++X)
+			{
+				TArray<const UEdGraphNode*>* Candidates = NodesByCellB.Find(FTitleCell(*TitleId, FIntPoint(X, Y)));
+				if (!Candidates)
+				{
+					continue;
+				}
+
+				for (int32 i = 0; i < Candidates->Num(); ++i)
+				{
+					const int64 DX = (*Candidates)[i]->NodePosX - Node->NodePosX;
+					const int64 DY = (*Candidates)[i]->NodePosY - Node->NodePosY;
+					const int64 Distance = DX * DX + DY * DY;
+					if (Distance < NearestDistance)
+					{
+						NearestCell = Candidates;
+						Nearest = i;
+						NearestDistance = Distance;
+					}
+				}
+			}
+		}
+
+		const UEdGraphNode* Match = nullptr;
+
+		if (NearestCell)
+		{
+			Match = (*NearestCell)[Nearest];
+			NearestCell->RemoveAtSwap(Nearest);
+		}
+		else
+		{
+			// nothing close, any candidate with the title. Each one is popped at most once over the whole graph
+			TArray<const UEdGraphNode*>& Remaining = NodesByTitleB[*TitleId];
+			while (Remaining.Num() > 0 && MatchedB.Contains(Remaining.Last()))
+			{
+				Remaining.Pop(false);
+			}
+
+			if (Remaining.Num() == 0)
+			{
+				continue;
+			}
+
+			Match = Remaining.Pop(false);
+			NodesByCellB.FindChecked(FTitleCell(*TitleId, GetCell(Match))).RemoveSingleSwap(Match);
+		}
+
+		OutMatches.Add(Node, Match);
+		MatchedB.Add(Match);
+	}
+}
+
+void FBlueprintGraphComparer::CompareGraphs(const FString& PathA, const FString& PathB, const UEdGraph* A, const UEdGraph* B)
+{
+	TMap<const UEdGraphNode*, const UEdGraphNode*> Matches;
+	MatchNodes(A, B, Matches);
+
+	TSet<const UEdGraphNode*> MatchedB;
+	for (const TPair<const UEdGraphNode*, const UEdGraphNode*>& Pair : Matches)
+	{
+		MatchedB.Add(Pair.Value);
+	}
+
+	for (const UEdGraphNode* Node : A->Nodes)
+	{
+		if (!Node)
+		{
+			continue;
+		}
+
+		const UEdGraphNode* const* Match = Matches.Find(Node);
+		if (!Match)
+		{
+			AddMessage("Node " + GetNodeTitle(Node) + " (" + GetNodeName(Node) + ") is only in " + PathA, EDifferenceType::Warning);
+			continue;
+		}
+
+		CompareNodes(PathA + "/" + GetNodeName(Node), PathB + "/" + GetNodeName(*Match), Node, *Match, Matches);
+	}
+
+	for (const UEdGraphNode* Node : B->Nodes)
+	{
+		if (Node && !MatchedB.Contains(Node))
+		{
+			AddMessage("Node " + GetNodeTitle(Node) + " (" + GetNodeName(Node) + ") is only in " + PathB, EDifferenceType::Warning);
+		}
+	}
+}
+
+void FBlueprintGraphComparer::CompareNodes(const FString& PathA, const FString& PathB, const UEdGraphNode* A, const UEdGraphNode* B,
+	const TMap<const UEdGraphNode*, const UEdGraphNode*>& Matches)
+{
+	if (A->GetClass() != B->GetClass())
+	{
+		AddDifference(PathA + "/Class", PathB + "/Class", A->GetClass()->GetName(), B->GetClass()->GetName());
+	}
+
+	TMap<FPinKey, const UEdGraphPin*> PinsB;
+	for (const UEdGraphPin* Pin : B->Pins)
+	{
+		PinsB.Add(MakePinKey(Pin), Pin);
+	}
+
+	for (const UEdGraphPin* PinA : A->Pins)
+	{
+		const UEdGraphPin* PinB = nullptr;
+		if (!PinsB.RemoveAndCopyValue(MakePinKey(PinA), PinB))
+		{
+			AddMessage("Pin " + PinA->PinName.ToString() + " is only on " + PathA, EDifferenceType::Warning);
+			continue;
+		}
+
+		const FString PinPathA = GetPinPath(PathA, PinA);
+		const FString PinPathB = GetPinPath(PathB, PinB);
+
+		if (PinA->PinType != PinB->PinType)
+		{
+			AddDifference(PinPathA + "/Type", PinPathB + "/Type", UEdGraphSchema_K2::TypeToText(PinA->PinType).ToString(), UEdGraphSchema_K2::TypeToText(PinB->PinType).ToString());
+		}
+
+		// a linked input ignores its default value
+		const FString DefaultA = PinA->GetDefaultAsString();
+		const FString DefaultB = PinB->GetDefaultAsString();
+		if (DefaultA != DefaultB && (PinA->LinkedTo.Num() == 0 || PinB->LinkedTo.Num() == 0))
+		{
+			AddDifference(PinPathA, PinPathB, DefaultA, DefaultB);
+		}
+
+		ComparePinLinks(PinPathA, PinPathB, PinA, PinB, Matches);
+	}
+
+	for (const TPair<FPinKey, const UEdGraphPin*>& Pair : PinsB)
+	{
+		AddMessage("Pin " + Pair.Key.Key.ToString() + " is only on " + PathB, EDifferenceType::Warning);
+	}
+}
+
+void FBlueprintGraphComparer::ComparePinLinks(const FString& PathA, const FString& PathB, const UEdGraphPin* A, const UEdGraphPin* B,
+	const TMap<const UEdGraphNode*, const UEdGraphNode*>& Matches)
+{
+	if (A->LinkedTo.Num() == 0 && B->LinkedTo.Num() == 0)
+	{
+		return;
+	}
+
+	// one row per connection which is only on one side, below the pin by the node and pin on the other end
+	auto LinkPath = [](const FString& PinPath, const UEdGraphNode* Node, FName PinName) -> FString
+	{
+		return PinPath + "/LinkedTo/" + GetNodeName(Node) + "." + PinName.ToString();
+	};
+
+	auto DescribeLink = [](const UEdGraphNode* Node, FName PinName) -> FString
+	{
+		return "connected to " + GetNodeTitle(Node) + "." + PinName.ToString();
+	};
+
+	// connections of B, and connections of A mapped onto the B nodes they were matched with
+	TSet<FLinkKey> LinksB;
+	for (const UEdGraphPin* Linked : B->LinkedTo)
+	{
+		if (Linked)
+		{
+			LinksB.Add(FLinkKey(Linked->GetOwningNode(), Linked->PinName));
+		}
+	}
+
+	for (const UEdGraphPin* Linked : A->LinkedTo)
+	{
+		if (!Linked)
+		{
+			continue;
+		}
+
+		const UEdGraphNode* const* Match = Matches.Find(Linked->GetOwningNode());
+		if (Match && LinksB.Remove(FLinkKey(*Match, Linked->PinName)) > 0)
+		{
+			continue;
+		}
+
+		const UEdGraphNode* LinkedNode = Linked->GetOwningNode();
+		AddDifference(LinkPath(PathA, LinkedNode, Linked->PinName), LinkPath(PathB, Match ? *Match : LinkedNode, Linked->PinName),
+			DescribeLink(LinkedNode, Linked->PinName), "not connected");
+	}
+
+	for (const FLinkKey& Link : LinksB)
+	{
+		AddDifference(LinkPath(PathA, Link.Key, Link.Value), LinkPath(PathB, Link.Key, Link.Value), "not connected", DescribeLink(Link.Key, Link.Value));
+	}
+}
+
+FString FBlueprintGraphComparer::GetNodeName(const UEdGraphNode* Node)
+{
+	// object names are unique in the graph and never have a '/', titles repeat ("Branch") and can have either
+	return Node->GetName();
+}
+
+FString FBlueprintGraphComparer::GetNodeTitle(const UEdGraphNode* Node)
+{
+	FString Title = Node->GetNodeTitle(ENodeTitleType::ListView).ToString();
+	Title.ReplaceInline(TEXT("\r"), TEXT(""));
+	Title.ReplaceInline(TEXT("\n"), TEXT(" "));
+	return Title;
+}
+
+FString FBlueprintGraphComparer::GetPinPath(const FString& NodePath, const UEdGraphPin* Pin)
+{
+	return NodePath + (Pin->Direction == EGPD_Input ? "/Inputs/" : "/Outputs/") + Pin->PinName.ToString();
+}
+
+void FBlueprintGraphComparer::AddMessage(const FString& Message, EDifferenceType Type)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = Type;
+	Diff->Message = Message;
+	Results.Add(Diff);
+}
+
+void FBlueprintGraphComparer::AddDifference(const FString& PathA, const FString& PathB, const FString& ValueA, const FString& ValueB)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = EDifferenceType::Difference;
+	Diff->Paths.Add(PathA);
+	Diff->Paths.Add(PathB);
+	Diff->ValuesAsString.Add(ValueA);
+	Diff->ValuesAsString.Add(ValueB);
+	Results.Add(Diff);
+}
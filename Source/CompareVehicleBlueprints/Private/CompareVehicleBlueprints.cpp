@@ -10,6 +10,18 @@
 #include "ToolMenus.h"
 #include "UIInputData.h"
 #include "MainWindow.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "VehicleHistory.h"
+#include "Engine/Blueprint.h"
+#include "Misc/PackageName.h"
+#include "UObject/ObjectSaveContext.h"
+#include "UObject/Package.h"
+#include "WheeledVehiclePawn.h"
+#include "ComparisonMemory.h"
+
+DEFINE_LOG_CATEGORY(LogCompareVehicleBlueprints);
+
+LLM_DEFINE_TAG(CompareVehicleBlueprints);
 
 static const FName CompareVehicleBlueprintsTabName("Compare Vehicle Blueprints");
 
@@ -38,6 +50,12 @@ void FCompareVehicleBlueprintsModule::StartupModule()
 		.SetMenuType(ETabSpawnerMenuType::Hidden);
 
 	InputData = MakeShared< FInputData >();
+
+	// commandlets and cooks save packages too, only saves by a user make a revision
+	if (!IsRunningCommandlet())
+	{
+		PackageSavedHandle = UPackage::PackageSavedWithContextEvent.AddRaw(this, &FCompareVehicleBlueprintsModule::OnPackageSaved);
+	}
 }
 
 void FCompareVehicleBlueprintsModule::ShutdownModule()
@@ -54,6 +72,8 @@ void FCompareVehicleBlueprintsModule::ShutdownModule()
 	FCompareVehicleBlueprintsCommands::Unregister();
 
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(CompareVehicleBlueprintsTabName);
+
+	UPackage::PackageSavedWithContextEvent.Remove(PackageSavedHandle);
 }
 
 TSharedRef<SDockTab> FCompareVehicleBlueprintsModule::OnSpawnPluginTab(const FSpawnTabArgs& SpawnTabArgs)
@@ -81,6 +101,27 @@ void FCompareVehicleBlueprintsModule::PluginButtonClicked()
 	FGlobalTabmanager::Get()->TryInvokeTab(CompareVehicleBlueprintsTabName);
 }
 
+void FCompareVehicleBlueprintsModule::OnPackageSaved(const FString& PackageFileName, UPackage* Package, FObjectPostSaveContext Context)
+{
+	if (!GetDefault<UCompareVehicleBlueprintsSettings>()->bRecordHistoryOnSave)
+	{
+		return;
+	}
+
+	if (!Context.SaveSucceeded() || Context.IsProceduralSave() || (Context.GetSaveFlags() & SAVE_FromAutosave) != 0)
+	{
+		return;
+	}
+
+	const UBlueprint* Blueprint = FindObject<UBlueprint>(Package, *FPackageName::GetShortName(Package));
+	if (!Blueprint || !Blueprint->GeneratedClass || !Blueprint->GeneratedClass->IsChildOf(AWheeledVehiclePawn::StaticClass()))
+	{
+		return;
+	}
+
+	FVehicleHistory::RecordRevision(Blueprint->GetPathName());
+}
+
 void FCompareVehicleBlueprintsModule::RegisterMenus()
 {
 	// Owner will be used for cleanup in call to UToolMenus::UnregisterOwner
@@ -0,0 +1,432 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "CompareVehicleBlueprintsCommandlet.h"
+#include "CompareVehicleBlueprints.h"
+#include "VehicleCompareImpl.h"
+#include "VehicleSnapshot.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "VehicleAssetFilter.h"
+#include "FleetSubtreeIndex.h"
+#include "FleetRunner.h"
+#include "FleetCoordinator.h"
+#include "VehicleHistory.h"
+#include "UObject/StrongObjectPtr.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+
+UCompareVehicleBlueprintsCommandlet::UCompareVehicleBlueprintsCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCompareVehicleBlueprintsCommandlet::Main(const FString& Params)
+{
+	FString Mode;
+	FParse::Value(*Params, TEXT("Mode="), Mode);
+
+	const TArray<FString> Vehicles = FindVehicles(Params);
+
+	if (Mode == TEXT("List"))
+	{
+		for (const FString& VehicleAssetPath : Vehicles)
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%s"), *VehicleAssetPath);
+		}
+
+		UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("Found %d wheeled vehicle blueprints"), Vehicles.Num());
+		return 0;
+	}
+
+	if (Mode == TEXT("Duplicates"))
+	{
+		int32 MinVehicles = 2;
+		int32 MinSize = 2;
+		FParse::Value(*Params, TEXT("MinVehicles="), MinVehicles);
+		FParse::Value(*Params, TEXT("MinSize="), MinSize);
+
+		return FindDuplicates(Vehicles, MinVehicles, MinSize);
+	}
+
+	if (Mode == TEXT("History"))
+	{
+		int32 NumFailed = 0;
+		for (const FString& VehicleAssetPath : Vehicles)
+		{
+			NumFailed += ShowHistory(VehicleAssetPath, Params) != 0 ? 1 : 0;
+		}
+		return NumFailed > 0 ? 1 : 0;
+	}
+
+	FString SnapshotFile;
+	FString SnapshotDir;
+	FParse::Value(*Params, TEXT("Snapshot="), SnapshotFile);
+	FParse::Value(*Params, TEXT("SnapshotDir="), SnapshotDir);
+
+	// one vehicle can use -Snapshot, a fleet needs a directory with a snapshot per vehicle
+	const bool bSingleSnapshot = Vehicles.Num() == 1 && !SnapshotFile.IsEmpty();
+
+	if (Vehicles.Num() == 0 || (!bSingleSnapshot && SnapshotDir.IsEmpty()))
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Usage: -run=CompareVehicleBlueprints -Mode=List|Duplicates|History|Record|Verify (-Vehicle=<asset path> -Snapshot=<file> | -Path=<content paths> [-Name=<wildcard>] -SnapshotDir=<directory>) [-Allow=<wildcards>] [-AllowList=<file>]"));
+		return 1;
+	}
+
+	auto GetSnapshotFile = [&](const FString& VehicleAssetPath) -> FString
+	{
+		return bSingleSnapshot ? SnapshotFile : SnapshotFileForVehicle(SnapshotDir, VehicleAssetPath);
+	};
+
+	if (Mode != TEXT("Record") && Mode != TEXT("Verify"))
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Unknown mode \"%s\", expected List, Duplicates, History, Record or Verify"), *Mode);
+		return 1;
+	}
+
+	TArray<FString> AllowList;
+	if (!ReadAllowList(Params, AllowList))
+	{
+		return 1;
+	}
+
+	FFleetReport Report;
+
+	int32 NumWorkers = 0;
+	FParse::Value(*Params, TEXT("Workers="), NumWorkers);
+
+	if (NumWorkers > 1 && !bSingleSnapshot && !FParse::Param(*Params, TEXT("Worker")))
+	{
+		// split the fleet across worker processes, they find their snapshots and allow list from the same arguments
+		FString WorkerArgs = TEXT("-SnapshotDir=\"") + FPaths::ConvertRelativePathToFull(SnapshotDir) + TEXT("\"");
+		if (AllowList.Num() > 0)
+		{
+			WorkerArgs += TEXT(" -Allow=\"") + FString::Join(AllowList, TEXT(",")) + TEXT("\"");
+		}
+
+		FFleetCoordinator Coordinator;
+		Coordinator.NumWorkers = NumWorkers;
+		FParse::Value(*Params, TEXT("AssetsPerWorker="), Coordinator.AssetsPerWorker);
+
+		if (!Coordinator.Run(Vehicles, Mode, WorkerArgs, Report))
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("No worker processes could be started"));
+			return 1;
+		}
+
+		for (const FFleetVehicleResult& Vehicle : Report.Vehicles)
+		{
+			LogResults(Vehicle.Results);
+		}
+	}
+	else
+	{
+		FFleetRunner Runner;
+		Runner.Run(Vehicles, [&](const FString& VehicleAssetPath)
+		{
+			FFleetVehicleResult& Vehicle = Report.Vehicles.AddDefaulted_GetRef();
+			Vehicle.VehicleAssetPath = VehicleAssetPath;
+
+			if (Mode == TEXT("Record"))
+			{
+				Record(VehicleAssetPath, GetSnapshotFile(VehicleAssetPath), Vehicle);
+			}
+			else
+			{
+				Verify(VehicleAssetPath, GetSnapshotFile(VehicleAssetPath), AllowList, Vehicle);
+			}
+
+			LogResults(Vehicle.Results);
+		});
+	}
+
+	// a worker hands its results back to the coordinator, anyone can ask for the merged report
+	FString ReportFile;
+	if (FParse::Value(*Params, TEXT("Result="), ReportFile) || FParse::Value(*Params, TEXT("Report="), ReportFile))
+	{
+		if (!Report.SaveToFile(ReportFile))
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Cannot write report %s"), *ReportFile);
+			return 1;
+		}
+	}
+
+	const int32 NumFailed = Report.GetNumFailed();
+
+	if (Vehicles.Num() > 1)
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%s: %d of %d vehicles failed"), *Mode, NumFailed, Vehicles.Num());
+	}
+
+	return NumFailed > 0 ? 1 : 0;
+}
+
+TArray<FString> UCompareVehicleBlueprintsCommandlet::FindVehicles(const FString& Params) const
+{
+	FString VehicleAssetPath;
+	if (FParse::Value(*Params, TEXT("Vehicle="), VehicleAssetPath))
+	{
+		return { VehicleAssetPath };
+	}
+
+	// a shard of a fleet job handed to a worker process
+	FString AssetListFile;
+	if (FParse::Value(*Params, TEXT("AssetList="), AssetListFile))
+	{
+		TArray<FString> Vehicles;
+		if (!FFileHelper::LoadFileToStringArray(Vehicles, *AssetListFile))
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Cannot read asset list %s"), *AssetListFile);
+		}
+		return Vehicles;
+	}
+
+	// the whole fleet, or the vehicles under some content paths
+	FString PackagePaths;
+	FString NameFilter = "*";
+	FParse::Value(*Params, TEXT("Path="), PackagePaths, false);
+	FParse::Value(*Params, TEXT("Name="), NameFilter);
+
+	if (PackagePaths.IsEmpty() && !FParse::Param(*Params, TEXT("Fleet")))
+	{
+		return {};
+	}
+
+	TArray<FString> Paths;
+	PackagePaths.ParseIntoArray(Paths, TEXT(","));
+
+	// the registry is filled in the background in the editor, a commandlet has to scan before querying
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	if (Paths.Num() > 0)
+	{
+		AssetRegistry.ScanPathsSynchronous(Paths);
+	}
+	else
+	{
+		AssetRegistry.SearchAllAssets(true);
+	}
+
+	FVehicleAssetFilter VehicleAssetFilter;
+	return VehicleAssetFilter.FindWheeledVehicleBlueprints(Paths, NameFilter);
+}
+
+bool UCompareVehicleBlueprintsCommandlet::ReadAllowList(const FString& Params, TArray<FString>& OutAllowList) const
+{
+	// allowed differences, as a comma separated list and/or a file with one wildcard per line
+	FString Allow;
+	if (FParse::Value(*Params, TEXT("Allow="), Allow, false))
+	{
+		Allow.ParseIntoArray(OutAllowList, TEXT(","));
+	}
+
+	FString AllowListFile;
+	if (FParse::Value(*Params, TEXT("AllowList="), AllowListFile))
+	{
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *AllowListFile))
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Cannot read allow list %s"), *AllowListFile);
+			return false;
+		}
+
+		for (FString& Line : Lines)
+		{
+			Line.TrimStartAndEndInline();
+			if (!Line.IsEmpty() && !Line.StartsWith("#"))
+			{
+				OutAllowList.Add(Line);
+			}
+		}
+	}
+
+	return true;
+}
+
+FString UCompareVehicleBlueprintsCommandlet::SnapshotFileForVehicle(const FString& SnapshotDir, const FString& VehicleAssetPath)
+{
+	// /Game/Cars/BP_Car.BP_Car -> <SnapshotDir>/Game/Cars/BP_Car.json
+	const FString PackageName = FPackageName::ObjectPathToPackageName(VehicleAssetPath);
+	return FPaths::Combine(SnapshotDir, PackageName.RightChop(1) + TEXT(".json"));
+}
+
+void UCompareVehicleBlueprintsCommandlet::Record(const FString& VehicleAssetPath, const FString& SnapshotFile, FFleetVehicleResult& OutResult)
+{
+	UVehicleCompareImpl* Impl = NewObject<UVehicleCompareImpl>();
+
+	FVehicleSnapshot Snapshot;
+	const bool bCaptured = Impl->CaptureVehicleSnapshot(VehicleAssetPath, Snapshot);
+
+	OutResult.Results = Impl->GetResults();
+
+	if (!bCaptured)
+	{
+		OutResult.bFailed = true;
+		return;
+	}
+
+	if (!Snapshot.SaveToFile(SnapshotFile))
+	{
+		AddResult(OutResult, EDifferenceType::Error, "Cannot write snapshot " + SnapshotFile);
+		OutResult.bFailed = true;
+		return;
+	}
+
+	AddResult(OutResult, EDifferenceType::Info, "Recorded " + FString::FromInt(Snapshot.Values.Num()) + " properties of " + VehicleAssetPath + " to " + SnapshotFile);
+}
+
+void UCompareVehicleBlueprintsCommandlet::Verify(const FString& VehicleAssetPath, const FString& SnapshotFile, const TArray<FString>& AllowList, FFleetVehicleResult& OutResult)
+{
+	FVehicleSnapshot Snapshot;
+	if (!Snapshot.LoadFromFile(SnapshotFile))
+	{
+		AddResult(OutResult, EDifferenceType::Error, "Cannot read snapshot " + SnapshotFile);
+		OutResult.bFailed = true;
+		return;
+	}
+
+	UVehicleCompareImpl* Impl = NewObject<UVehicleCompareImpl>();
+
+	const int32 NumFailures = Impl->CompareVehicleWithSnapshot(VehicleAssetPath, Snapshot, AllowList);
+
+	OutResult.Results = Impl->GetResults();
+
+	if (NumFailures > 0)
+	{
+		AddResult(OutResult, EDifferenceType::Error, VehicleAssetPath + " differs from snapshot " + SnapshotFile + " in " + FString::FromInt(NumFailures) + " properties");
+		OutResult.bFailed = true;
+		return;
+	}
+
+	AddResult(OutResult, EDifferenceType::Info, VehicleAssetPath + " matches snapshot " + SnapshotFile);
+}
+
+void UCompareVehicleBlueprintsCommandlet::AddResult(FFleetVehicleResult& OutResult, EDifferenceType Type, const FString& Message)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = Type;
+	Diff->Message = Message;
+	OutResult.Results.Add(Diff);
+}
+
+int32 UCompareVehicleBlueprintsCommandlet::ShowHistory(const FString& VehicleAssetPath, const FString& Params)
+{
+	const FString HistoryFile = FVehicleHistory::GetHistoryFile(VehicleAssetPath);
+
+	FVehicleHistory History;
+	if (!History.LoadFromFile(HistoryFile))
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Cannot read vehicle history %s"), *HistoryFile);
+		return 1;
+	}
+
+	auto LogChange = [](const FVehicleHistoryChange& Change)
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("r%d %s %s: %s -> %s"),
+			Change.Revision, *Change.Time.ToString(), *Change.Path, *Change.OldValue, *Change.NewValue);
+	};
+
+	// when did a property change
+	FString Property;
+	if (FParse::Value(*Params, TEXT("Property="), Property))
+	{
+		const TArray<FVehicleHistoryChange> Changes = History.FindChanges(Property);
+		for (const FVehicleHistoryChange& Change : Changes)
+		{
+			LogChange(Change);
+		}
+
+		UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%s: %d changes to %s in %d revisions"), *VehicleAssetPath, Changes.Num(), *Property, History.GetLatestRevision() + 1);
+		return 0;
+	}
+
+	// what changed between two revisions, by default the last two
+	int32 ToRevision = History.GetLatestRevision();
+	FParse::Value(*Params, TEXT("To="), ToRevision);
+
+	int32 FromRevision = FMath::Max(ToRevision - 1, 0);
+	FParse::Value(*Params, TEXT("From="), FromRevision);
+
+	TArray<FVehicleHistoryChange> Changes;
+	if (!History.GetChangesBetween(FromRevision, ToRevision, Changes))
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("%s has revisions 0 to %d, cannot compare %d with %d"), *VehicleAssetPath, History.GetLatestRevision(), FromRevision, ToRevision);
+		return 1;
+	}
+
+	for (const FVehicleHistoryChange& Change : Changes)
+	{
+		LogChange(Change);
+	}
+
+	UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%s: %d changes from revision %d to %d"), *VehicleAssetPath, Changes.Num(), FromRevision, ToRevision);
+	return 0;
+}
+
+int32 UCompareVehicleBlueprintsCommandlet::FindDuplicates(const TArray<FString>& Vehicles, int32 MinVehicles, int32 MinSize)
+{
+	// the runner collects garbage between batches, keep the comparer alive across them
+	TStrongObjectPtr<UVehicleCompareImpl> Impl(NewObject<UVehicleCompareImpl>());
+
+	FFleetSubtreeIndex Index;
+
+	FFleetRunner Runner;
+	Runner.Run(Vehicles, [&](const FString& VehicleAssetPath)
+	{
+		FVehicleComponents Components;
+		if (Impl->LoadVehicleComponents(VehicleAssetPath, Components))
+		{
+			Index.AddVehicle(VehicleAssetPath, Components);
+		}
+	});
+
+	LogResults(Impl->GetResults());
+
+	const TArray<FDuplicateSubtreeGroup> Duplicates = Index.FindDuplicates(MinVehicles, MinSize);
+
+	for (const FDuplicateSubtreeGroup& Group : Duplicates)
+	{
+		// name the group after the property its first member is stored in
+		FString Name = Group.Members[0]->Path;
+		FString PropertyName;
+		if (Name.Split(".", nullptr, &PropertyName, ESearchCase::CaseSensitive, ESearchDir::FromEnd))
+		{
+			Name = PropertyName;
+		}
+
+		UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%d vehicles share an identical %s (%s, %d values, %d copies)"),
+			Group.NumVehicles, *Name, *Group.TypeName, Group.Size, Group.Members.Num());
+
+		for (const FSubtreeRecord* Member : Group.Members)
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("    %s %s"), *Member->VehicleAssetPath, *Member->Path);
+		}
+	}
+
+	UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("Found %d groups of duplicated data in %d vehicles"), Duplicates.Num(), Vehicles.Num());
+	return 0;
+}
+
+void UCompareVehicleBlueprintsCommandlet::LogResults(const TArray<TSharedRef<FDifference>>& Results) const
+{
+	for (const TSharedRef<FDifference>& Diff : Results)
+	{
+		switch (Diff->Type)
+		{
+		case EDifferenceType::Info:
+			UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%s"), *Diff->Message);
+			break;
+		case EDifferenceType::Warning:
+			UE_LOG(LogCompareVehicleBlueprints, Warning, TEXT("%s"), *Diff->Message);
+			break;
+		case EDifferenceType::Error:
+			UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("%s"), *Diff->Message);
+			break;
+		case EDifferenceType::Difference:
+			UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("%s = %s, %s = %s"), *Diff->Paths[0], *Diff->ValuesAsString[0], *Diff->Paths[1], *Diff->ValuesAsString[1]);
+			break;
+		}
+	}
+}
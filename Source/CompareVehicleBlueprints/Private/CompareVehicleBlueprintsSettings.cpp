@@ -0,0 +1,8 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "CompareVehicleBlueprintsSettings.h"
+
+UCompareVehicleBlueprintsSettings::UCompareVehicleBlueprintsSettings()
+{
+	SectionName = TEXT("CompareVehicleBlueprints");
+}
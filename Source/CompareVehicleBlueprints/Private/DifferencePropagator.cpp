@@ -0,0 +1,254 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "DifferencePropagator.h"
+#include "VehicleCompareImpl.h"
+#include "PropertyPathHelpers.h"
+#include "ScopedTransaction.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/InheritableComponentHandler.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+
+#define LOCTEXT_NAMESPACE "CompareVehicleBlueprints"
+
+int32 FDifferencePropagator::Apply(const FString& SourceVehicleAssetPath, const TArray<TSharedRef<FDifference>>& Differences,
+	const TArray<FString>& TargetVehicleAssetPaths, TArray<TSharedRef<FDifference>>& OutMessages)
+{
+	// compiling a target can collect garbage
+	TStrongObjectPtr<UVehicleCompareImpl> Impl(NewObject<UVehicleCompareImpl>());
+
+	FVehicleComponents Source;
+	if (!Impl->LoadVehicleComponents(SourceVehicleAssetPath, Source))
+	{
+		OutMessages.Append(Impl->GetResults());
+		return 0;
+	}
+
+	TArray<FVehicleComponents> Targets;
+
+	for (const FString& TargetVehicleAssetPath : TargetVehicleAssetPaths)
+	{
+		FVehicleComponents& Target = Targets.AddDefaulted_GetRef();
+		if (!Impl->LoadVehicleComponents(TargetVehicleAssetPath, Target))
+		{
+			Targets.Pop();
+		}
+	}
+
+	OutMessages.Append(Impl->GetResults());
+
+	return Apply(Source, Differences, Targets, OutMessages);
+}
+
+int32 FDifferencePropagator::Apply(const FVehicleComponents& Source, const TArray<TSharedRef<FDifference>>& Differences,
+	const TArray<FVehicleComponents>& Targets, TArray<TSharedRef<FDifference>>& OutMessages)
+{
+	const FString& SourceVehicleAssetPath = Source.AssetPath;
+
+	// read each value from the source once, as text so it can be set on any target
+	struct FEdit
+	{
+		FName Component;
+		FString PropertyPath;
+		FString Value;
+	};
+
+	TArray<FEdit> Edits;
+
+	for (const TSharedRef<FDifference>& Diff : Differences)
+	{
+		if (Diff->Component.IsNone() || Diff->PropertyPath.IsEmpty())
+		{
+			continue;
+		}
+
+		UObject* SourceComponent = FindComponent(Source, Diff->Component);
+
+		FEdit Edit;
+		Edit.Component = Diff->Component;
+		Edit.PropertyPath = Diff->PropertyPath;
+
+		if (!SourceComponent || !PropertyPathHelpers::GetPropertyValueAsString(SourceComponent, Edit.PropertyPath, Edit.Value))
+		{
+			AddMessage(OutMessages, "Cannot read " + Diff->Component.ToString() + "." + Diff->PropertyPath + " from " + SourceVehicleAssetPath, EDifferenceType::Warning);
+			continue;
+		}
+
+		Edits.Add(MoveTemp(Edit));
+	}
+
+	if (Edits.Num() == 0)
+	{
+		AddMessage(OutMessages, "None of the selected rows are component values which can be copied", EDifferenceType::Warning);
+		return 0;
+	}
+
+	int32 NumSet = 0;
+
+	for (const FVehicleComponents& GatheredTarget : Targets)
+	{
+		const FString& TargetVehicleAssetPath = GatheredTarget.AssetPath;
+
+		if (!GatheredTarget.Blueprint || TargetVehicleAssetPath == SourceVehicleAssetPath)
+		{
+			continue;
+		}
+
+		if (!IsValid(GatheredTarget.Blueprint))
+		{
+			AddMessage(OutMessages, TargetVehicleAssetPath + " was deleted before its values could be copied", EDifferenceType::Error);
+			continue;
+		}
+
+		// compiling an earlier target also recompiles the blueprints derived from it, which replaces their class default
+		// objects and templates. Gather again just before editing so the edits go to the live templates
+		FVehicleComponents Target;
+		Target.AssetPath = TargetVehicleAssetPath;
+		Target.GatherComponents(GatheredTarget.Blueprint);
+
+		// every edit to this blueprint is undone together
+		FScopedTransaction Transaction(FText::Format(LOCTEXT("CopyVehicleValues", "Copy Vehicle Values to {0}"), FText::FromString(Target.Blueprint->GetName())));
+		Target.Blueprint->Modify();
+
+		TArray<UObject*> ModifiedComponents;
+		TMap<FName, UObject*> EditableComponents;
+		int32 NumSetOnTarget = 0;
+
+		for (const FEdit& Edit : Edits)
+		{
+			UObject* Component = nullptr;
+			if (UObject** Found = EditableComponents.Find(Edit.Component))
+			{
+				Component = *Found;
+			}
+			else
+			{
+				FString Error;
+				Component = GetEditableComponent(Target, Edit.Component, Error);
+				EditableComponents.Add(Edit.Component, Component);
+
+				if (!Component)
+				{
+					AddMessage(OutMessages, Error, EDifferenceType::Error);
+				}
+			}
+
+			if (!Component)
+			{
+				continue;
+			}
+
+			if (!ModifiedComponents.Contains(Component))
+			{
+				Component->Modify();
+				Component->PreEditChange(nullptr);
+				ModifiedComponents.Add(Component);
+			}
+
+			if (!PropertyPathHelpers::SetPropertyValueFromString(Component, Edit.PropertyPath, Edit.Value))
+			{
+				AddMessage(OutMessages, "Cannot set " + Edit.Component.ToString() + "." + Edit.PropertyPath + " on " + TargetVehicleAssetPath, EDifferenceType::Warning);
+				continue;
+			}
+
+			++NumSetOnTarget;
+		}
+
+		for (UObject* Component : ModifiedComponents)
+		{
+			Component->PostEditChange();
+		}
+
+		if (NumSetOnTarget == 0)
+		{
+			Transaction.Cancel();
+			continue;
+		}
+
+		// once per blueprint however many values changed. The other targets are only held by raw pointers,
+		// so no garbage collection until all of them are done. Their templates are gathered again before they are edited
+		FBlueprintEditorUtils::MarkBlueprintAsModified(Target.Blueprint);
+		FKismetEditorUtilities::CompileBlueprint(Target.Blueprint, EBlueprintCompileOptions::SkipGarbageCollection);
+
+		AddMessage(OutMessages, "Copied " + FString::FromInt(NumSetOnTarget) + " values to " + TargetVehicleAssetPath, EDifferenceType::Info);
+		NumSet += NumSetOnTarget;
+	}
+
+	return NumSet;
+}
+
+UObject* FDifferencePropagator::FindComponent(const FVehicleComponents& Vehicle, FName ComponentName)
+{
+	for (const UObject* Object : Vehicle.Subobjects)
+	{
+		if (Object && Object->GetFName() == ComponentName)
+		{
+			// the templates are only read while comparing, here they are edited
+			return const_cast<UObject*>(Object);
+		}
+	}
+
+	return nullptr;
+}
+
+UObject* FDifferencePropagator::GetEditableComponent(const FVehicleComponents& Target, FName ComponentName, FString& OutError)
+{
+	UObject* Component = FindComponent(Target, ComponentName);
+	if (!Component)
+	{
+		OutError = Target.AssetPath + " has no component " + ComponentName.ToString();
+		return nullptr;
+	}
+
+	// native components on the class default object and the blueprint's own or overridden templates are in its package
+	if (Component->GetOutermost() == Target.Blueprint->GetOutermost())
+	{
+		return Component;
+	}
+
+	// otherwise this is a parent blueprint's template, the target needs an override of its own
+	UBlueprintGeneratedClass* GeneratedClass = Cast<UBlueprintGeneratedClass>(Target.Blueprint->GeneratedClass);
+
+	TArray<const UBlueprintGeneratedClass*> Hierarchy;
+	UBlueprintGeneratedClass::GetGeneratedClassesHierarchy(GeneratedClass, Hierarchy);
+
+	for (const UBlueprintGeneratedClass* Class : Hierarchy)
+	{
+		const USimpleConstructionScript* SCS = Class->SimpleConstructionScript;
+		if (!SCS || Class == GeneratedClass)
+		{
+			continue;
+		}
+
+		for (USCS_Node* Node : SCS->GetAllNodes())
+		{
+			if (Node && Node->ComponentTemplate == Component)
+			{
+				UInheritableComponentHandler* Handler = Target.Blueprint->GetInheritableComponentHandler(true);
+				Handler->Modify();
+
+				if (UActorComponent* Override = Handler->CreateOverridenComponentTemplate(FComponentKey(Node)))
+				{
+					return Override;
+				}
+			}
+		}
+	}
+
+	OutError = "Cannot copy to " + ComponentName.ToString() + " on " + Target.AssetPath + ", it belongs to " + Component->GetOutermost()->GetName()
+		+ " and " + Target.AssetPath + " cannot override it";
+	return nullptr;
+}
+
+void FDifferencePropagator::AddMessage(TArray<TSharedRef<FDifference>>& OutMessages, const FString& Message, EDifferenceType Type)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Message = Message;
+	Diff->Type = Type;
+	OutMessages.Add(Diff);
+}
+
+#undef LOCTEXT_NAMESPACE
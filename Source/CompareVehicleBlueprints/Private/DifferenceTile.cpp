@@ -3,176 +3,215 @@
 #include "DifferenceTile.h"
 #include "CompareVehicleBlueprintsStyle.h"
 #include "Difference.h"
-#include "Widgets/Layout/SGridPanel.h"
+#include "Widgets/SLeafWidget.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Fonts/FontMeasure.h"
+#include "Rendering/DrawElements.h"
 
 namespace
 {
-	constexpr int32 Padding = 10;
-	const FMargin TopSlotMargin(10, 10, 1, 10);
-	const FMargin BottomSlotMargin(10, 0, 10, 10);
-	constexpr int32 SpaceBetweenItems = 1;
-	const FSlateColor OuterBorderColor(FLinearColor::Gray);
-	const FMargin BorderTopMargin(0, 0, 0, SpaceBetweenItems);
-
-	TSharedRef<SWidget> WidgetForMessage(
-		const FString& StyleName, 
-		const FString& Message
-		)
+	constexpr float Padding = 10.0f;
+	constexpr float SpaceBetweenLines = 4.0f;
+	constexpr float SpaceBetweenItems = 1.0f;
+	const FLinearColor OuterBorderColor(FLinearColor::Gray);
+
+	// stats footer counters, widgets are only made and painted on the game thread
+	int32 NumLiveWidgets = 0;
+	uint64 PaintCycles = 0;
+
+	// one or two lines of text on a panel, painted directly instead of built from borders, boxes and text blocks.
+	// The text never changes so it is measured once per layout scale
+	class SDifferenceCell : public SLeafWidget
 	{
-		return SNew(SBorder)
-			.BorderImage(FAppStyle::Get().GetBrush("Brushes.Panel"))
-			.BorderBackgroundColor(OuterBorderColor)
-			.Padding(BorderTopMargin)
-			.VAlign(VAlign_Top)
-			[
-				SNew(SBorder)
-				.BorderImage(FAppStyle::Get().GetBrush("Brushes.Panel"))
-				.Padding(0)
-				.VAlign(VAlign_Top)
-				[
-					SNew(SVerticalBox)
-					+ SVerticalBox::Slot()
-					.Padding(Padding)
-					.HAlign(HAlign_Left)
-					.AutoHeight()
-					[
-						SNew(STextBlock)
-						.TextStyle(FCompareVehicleBlueprintsStyle::Get(), *StyleName)
-						.Text(FText::FromString(Message))
-						.AutoWrapText(true)
-					]
-				]
-			];
-
-	}
-}
+	public:
+		SLATE_BEGIN_ARGS(SDifferenceCell)
+			: _TextStyle(nullptr)
+		{
+		}
 
-void SDifferenceTile::Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTableView)
-{
-	// set the item, then get callbacks to fill the columns in GenerateWidgetForColumn()
-	Item = InArgs._InItem;
-	FSuperRowType::Construct(FSuperRowType::FArguments().Padding(0), InOwnerTableView);
-}
+		SLATE_ARGUMENT(TArray<FString>, Lines)
+		SLATE_ARGUMENT(const FTextBlockStyle*, TextStyle)
+		SLATE_END_ARGS()
 
-TSharedRef<SWidget> SDifferenceTile::GenerateWidgetForColumn(const FName& ColumnName)
-{
+		SDifferenceCell()
+		{
+			++NumLiveWidgets;
+		}
 
-	if (ColumnName == TEXT("Property"))
-	{
-		if (Item->Type == EDifferenceType::Info)
+		virtual ~SDifferenceCell()
 		{
-			return WidgetForMessage("Difference.InfoText", Item->Message);
+			--NumLiveWidgets;
 		}
-		
-		if (Item->Type == EDifferenceType::Warning)
+
+		void Construct(const FArguments& InArgs)
 		{
-			return WidgetForMessage("Difference.WarningText", Item->Message);
+			Lines.Append(InArgs._Lines);
+
+			TextStyle = InArgs._TextStyle ? InArgs._TextStyle : &FAppStyle::Get().GetWidgetStyle<FTextBlockStyle>("NormalText");
+			PanelBrush = FAppStyle::Get().GetBrush("Brushes.Panel");
+
+			// long paths and messages are cut off rather than wrapped, the tooltip has all of it
+			SetClipping(EWidgetClipping::ClipToBounds);
 		}
-		
-		if (Item->Type == EDifferenceType::Error)
+
+		virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override
 		{
-			return WidgetForMessage("Difference.ErrorText", Item->Message);
+			MeasureLines(LayoutScaleMultiplier);
+
+			FVector2D Size(0.0f, 0.0f);
+			if (LineSizes.Num() == 0)
+			{
+				return Size;
+			}
+
+			for (const FVector2D& LineSize : LineSizes)
+			{
+				Size.X = FMath::Max(Size.X, LineSize.X);
+				Size.Y += LineSize.Y;
+			}
+
+			return Size + FVector2D(2.0f * Padding, 2.0f * Padding + SpaceBetweenItems + (LineSizes.Num() - 1) * SpaceBetweenLines);
 		}
-		
-		if (Item->Type == EDifferenceType::Difference)
+
+		virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+			int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override
 		{
-			return SNew(SBorder)
-				.BorderImage(FAppStyle::Get().GetBrush("Brushes.Panel"))
-				.BorderBackgroundColor(OuterBorderColor)
-				.Padding(BorderTopMargin)
-				.VAlign(VAlign_Top)
-				[
-					SNew(SBorder)
-					.BorderImage(FAppStyle::Get().GetBrush("Brushes.Panel"))
-					.Padding(0)
-					.VAlign(VAlign_Top)
-					[
-						SNew(SVerticalBox)
-				
-						+ SVerticalBox::Slot()
-						.Padding(TopSlotMargin)
-						.HAlign(HAlign_Left)
-						.AutoHeight()
-						[
-							SNew(STextBlock)
-							.Text(FText::FromString(Item->Paths[0]))
-						]
-
-						+ SVerticalBox::Slot()
-						.HAlign(HAlign_Left)
-						.Padding(BottomSlotMargin)
-						.AutoHeight()
-						[
-							SNew(STextBlock)
-							.Text(FText::FromString(Item->Paths[1]))
-						]
-					]
-				];
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+
+			MeasureLines(AllottedGeometry.Scale);
+
+			// the gray outer panel shows through the gap at the bottom as a separator between rows
+			const FVector2D Size = AllottedGeometry.GetLocalSize();
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
+				PanelBrush, ESlateDrawEffect::None, OuterBorderColor * InWidgetStyle.GetColorAndOpacityTint());
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(Size.X, Size.Y - SpaceBetweenItems), FSlateLayoutTransform()),
+				PanelBrush, ESlateDrawEffect::None, InWidgetStyle.GetColorAndOpacityTint());
 
+			const FLinearColor TextColor = TextStyle->ColorAndOpacity.GetColor(InWidgetStyle) * InWidgetStyle.GetColorAndOpacityTint();
+
+			float Y = Padding;
+			for (int32 i = 0; i < Lines.Num(); ++i)
+			{
+				FSlateDrawElement::MakeText(OutDrawElements, LayerId + 1,
+					AllottedGeometry.ToPaintGeometry(LineSizes[i], FSlateLayoutTransform(FVector2D(Padding, Y))),
+					Lines[i], TextStyle->Font, ESlateDrawEffect::None, TextColor);
+
+				Y += LineSizes[i].Y + SpaceBetweenLines;
+			}
+
+			PaintCycles += FPlatformTime::Cycles64() - StartCycles;
+
+			return LayerId + 1;
 		}
-	}
-	else if( ColumnName == TEXT("Value") )
-	{
-		// for messages the text is in the left column, do this to generate the border and backgrounds
-		if (Item->Type == EDifferenceType::Info)
+
+		virtual TSharedPtr<IToolTip> GetToolTip() override
 		{
-			TSharedRef<SWidget> W = WidgetForMessage("Difference.InfoText", "");
-			W->SetVisibility(EVisibility::Collapsed);
-			return W;
+			// made on first hover, most cells are never hovered
+			if (!SLeafWidget::GetToolTip().IsValid())
+			{
+				SetToolTip(FSlateApplicationBase::Get().MakeToolTip(FText::FromString(FString::Join(Lines, TEXT("\n")))));
+			}
+
+			return SLeafWidget::GetToolTip();
 		}
 
-		if (Item->Type == EDifferenceType::Warning)
+	private:
+		void MeasureLines(float Scale) const
 		{
-			TSharedRef<SWidget> W = WidgetForMessage("Difference.WarningText", "");
-			W->SetVisibility(EVisibility::Collapsed);
-			return W;
+			if (Scale == MeasuredScale)
+			{
+				return;
+			}
+
+			const TSharedRef<FSlateFontMeasure> FontMeasure = FSlateApplication::Get().GetRenderer()->GetFontMeasureService();
+
+			LineSizes.Reset();
+			for (const FString& Line : Lines)
+			{
+				LineSizes.Add(FontMeasure->Measure(Line, TextStyle->Font, Scale) / Scale);
+			}
+
+			MeasuredScale = Scale;
 		}
 
-		if (Item->Type == EDifferenceType::Error)
+	private:
+		TArray<FString, TInlineAllocator<2>> Lines;
+
+		const FTextBlockStyle* TextStyle = nullptr;
+		const FSlateBrush* PanelBrush = nullptr;
+
+		mutable TArray<FVector2D, TInlineAllocator<2>> LineSizes;
+		mutable float MeasuredScale = 0.0f;
+	};
+
+	const FTextBlockStyle* StyleForMessage(EDifferenceType Type)
+	{
+		switch (Type)
 		{
-			TSharedRef<SWidget> W = WidgetForMessage("Difference.ErrorText", "");
-			W->SetVisibility(EVisibility::Collapsed);
-			return W;
+		case EDifferenceType::Info: return &FCompareVehicleBlueprintsStyle::Get().GetWidgetStyle<FTextBlockStyle>("Difference.InfoText");
+		case EDifferenceType::Warning: return &FCompareVehicleBlueprintsStyle::Get().GetWidgetStyle<FTextBlockStyle>("Difference.WarningText");
+		case EDifferenceType::Error: return &FCompareVehicleBlueprintsStyle::Get().GetWidgetStyle<FTextBlockStyle>("Difference.ErrorText");
+		default: return nullptr;
 		}
+	}
+}
+
+SDifferenceTile::SDifferenceTile()
+{
+	++NumLiveWidgets;
+}
+
+SDifferenceTile::~SDifferenceTile()
+{
+	--NumLiveWidgets;
+}
+
+int32 SDifferenceTile::GetNumLiveWidgets()
+{
+	return NumLiveWidgets;
+}
+
+double SDifferenceTile::ConsumePaintSeconds()
+{
+	const double Seconds = FPlatformTime::ToSeconds64(PaintCycles);
+	PaintCycles = 0;
+	return Seconds;
+}
+
+void SDifferenceTile::Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTableView)
+{
+	// set the item, then get callbacks to fill the columns in GenerateWidgetForColumn()
+	Item = InArgs._InItem;
+	FSuperRowType::Construct(FSuperRowType::FArguments().Padding(0), InOwnerTableView);
+}
 
+TSharedRef<SWidget> SDifferenceTile::GenerateWidgetForColumn(const FName& ColumnName)
+{
+	const bool bIsMessage = Item->Type != EDifferenceType::Difference;
 
-		if (Item->Type == EDifferenceType::Difference)
+	if (ColumnName == TEXT("Property"))
+	{
+		if (bIsMessage)
 		{
-			return SNew(SBorder)
-				.BorderImage(FAppStyle::Get().GetBrush("Brushes.Panel"))
-				.BorderBackgroundColor(OuterBorderColor)
-				.Padding(BorderTopMargin)
-				.VAlign(VAlign_Top)
-				[
-					SNew(SBorder)
-					.BorderImage(FAppStyle::Get().GetBrush("Brushes.Panel"))
-					.Padding(0)
-					.VAlign(VAlign_Top)
-					[
-						SNew(SVerticalBox)
-				
-						+ SVerticalBox::Slot()
-						.Padding(TopSlotMargin)
-						.HAlign(HAlign_Left)
-						.AutoHeight()
-						[
-							SNew(STextBlock)
-							.Text(FText::FromString(Item->ValuesAsString[0]))
-						]
-
-						+ SVerticalBox::Slot()
-						.HAlign(HAlign_Left)
-						.Padding(BottomSlotMargin)
-						.AutoHeight()
-						[
-							SNew(STextBlock)
-							.Text(FText::FromString(Item->ValuesAsString[1]))
-						]
-					]
-				];
+			return SNew(SDifferenceCell)
+				.Lines({ Item->Message })
+				.TextStyle(StyleForMessage(Item->Type));
+		}
 
+		return SNew(SDifferenceCell)
+			.Lines(Item->Paths);
+	}
+	else if (ColumnName == TEXT("Value"))
+	{
+		// messages only use the property column, there is nothing to make here
+		if (bIsMessage)
+		{
+			return SNullWidget::NullWidget;
 		}
+
+		return SNew(SDifferenceCell)
+			.Lines(Item->ValuesAsString);
 	}
 
-	return SNew(STextBlock);
+	return SNullWidget::NullWidget;
 }
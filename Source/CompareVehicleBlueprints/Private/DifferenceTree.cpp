@@ -0,0 +1,238 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "DifferenceTree.h"
+#include "CompareVehicleBlueprintsStyle.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Views/SExpanderArrow.h"
+
+namespace
+{
+	constexpr TCHAR Separator = '/';
+
+	const FMargin CellPadding(4, 2);
+
+	// compare paths with the separator before every other character, so "A/B" is followed by "A/B/C" and then "A/B-C"
+	// and every subtree is one contiguous range
+	bool TreePathLess(const TCHAR* A, const TCHAR* B)
+	{
+		for (;; ++A, ++B)
+		{
+			if (*A == *B)
+			{
+				if (*A == 0)
+				{
+					return false;
+				}
+				continue;
+			}
+
+			if (*A == 0 || *B == 0)
+			{
+				return *A == 0;
+			}
+
+			if (*A == Separator || *B == Separator)
+			{
+				return *A == Separator;
+			}
+
+			return *A < *B;
+		}
+	}
+
+	const TCHAR* StyleForMessage(EDifferenceType Type)
+	{
+		switch (Type)
+		{
+		case EDifferenceType::Error: return TEXT("Difference.ErrorText");
+		case EDifferenceType::Warning: return TEXT("Difference.WarningText");
+		default: return TEXT("Difference.InfoText");
+		}
+	}
+}
+
+FDifferenceTreeNode::FDifferenceTreeNode(const TSharedRef<const TArray<TSharedRef<FDifference>>>& InDifferences, int32 InFirst, int32 InLast, int32 InPrefixLength)
+	: Differences(InDifferences)
+	, First(InFirst)
+	, Last(InLast)
+	, ChildrenFirst(InFirst)
+	, PrefixLength(InPrefixLength)
+{
+}
+
+const TCHAR* FDifferenceTreeNode::GetTreePath(const FDifference& Diff)
+{
+	if (Diff.Type != EDifferenceType::Difference || Diff.Paths.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	// the first segment is the vehicle, the same on every row
+	const TCHAR* Path = *Diff.Paths[0];
+	const TCHAR* AfterVehicle = FCString::Strchr(Path, Separator);
+	return AfterVehicle ? AfterVehicle + 1 : Path;
+}
+
+const TCHAR* FDifferenceTreeNode::GetPathBelow(const FDifference& Diff) const
+{
+	const TCHAR* Path = GetTreePath(Diff);
+	if (!Path)
+	{
+		return nullptr;
+	}
+
+	return Path + FMath::Min(PrefixLength, FCString::Strlen(Path));
+}
+
+void FDifferenceTreeNode::SortForTree(TArray<TSharedRef<FDifference>>& Differences)
+{
+	// stable so messages keep the order they were reported in
+	Differences.StableSort([](const TSharedRef<FDifference>& A, const TSharedRef<FDifference>& B)
+	{
+		const TCHAR* PathA = GetTreePath(*A);
+		const TCHAR* PathB = GetTreePath(*B);
+
+		if (!PathA || !PathB)
+		{
+			return !PathA && PathB;
+		}
+
+		return TreePathLess(PathA, PathB);
+	});
+}
+
+TSharedRef<FDifferenceTreeNode> FDifferenceTreeNode::MakeRoot(const TSharedRef<const TArray<TSharedRef<FDifference>>>& SortedDifferences)
+{
+	return MakeShareable(new FDifferenceTreeNode(SortedDifferences, 0, SortedDifferences->Num(), 0));
+}
+
+const TArray<TSharedRef<FDifferenceTreeNode>>& FDifferenceTreeNode::GetChildren()
+{
+	if (!bChildrenBuilt)
+	{
+		BuildChildren();
+		bChildrenBuilt = true;
+	}
+
+	return Children;
+}
+
+void FDifferenceTreeNode::BuildChildren()
+{
+	const TArray<TSharedRef<FDifference>>& Diffs = *Differences;
+
+	int32 Index = ChildrenFirst;
+	while (Index < Last)
+	{
+		const TCHAR* Path = GetTreePath(*Diffs[Index]);
+
+		// messages are only at the top, one row each
+		if (!Path)
+		{
+			TSharedRef<FDifferenceTreeNode> Child = MakeShareable(new FDifferenceTreeNode(Differences, Index, Index + 1, PrefixLength));
+			Child->Difference = Diffs[Index];
+			Child->ChildrenFirst = Index + 1;
+			Children.Add(Child);
+			++Index;
+			continue;
+		}
+
+		// the next segment of the path names the child, everything after it with the same segment is below it
+		const TCHAR* Segment = GetPathBelow(*Diffs[Index]);
+		const TCHAR* SegmentEnd = FCString::Strchr(Segment, Separator);
+		const int32 SegmentLength = SegmentEnd ? int32(SegmentEnd - Segment) : FCString::Strlen(Segment);
+		const bool bOnNode = Segment[SegmentLength] == 0;
+
+		int32 End = Index + 1;
+		while (End < Last)
+		{
+			const TCHAR* Next = GetPathBelow(*Diffs[End]);
+			if (!Next || FCString::Strncmp(Next, Segment, SegmentLength) != 0 || (Next[SegmentLength] != 0 && Next[SegmentLength] != Separator))
+			{
+				break;
+			}
+
+			// several differences at exactly the same path, e.g. the links of one pin, are leaf siblings and the
+			// last of them takes what is below
+			if (bOnNode && Next[SegmentLength] == 0)
+			{
+				break;
+			}
+			++End;
+		}
+
+		TSharedRef<FDifferenceTreeNode> Child = MakeShareable(new FDifferenceTreeNode(Differences, Index, End, PrefixLength + SegmentLength + 1));
+		Child->Name = FString(SegmentLength, Segment);
+
+		// sorting puts a difference on the node itself before the ones below it
+		if (bOnNode)
+		{
+			Child->Difference = Diffs[Index];
+			Child->ChildrenFirst = Index + 1;
+		}
+
+		Children.Add(Child);
+		Index = End;
+	}
+}
+
+void SDifferenceTreeRow::Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTableView)
+{
+	Item = InArgs._InItem;
+	FSuperRowType::Construct(FSuperRowType::FArguments().Padding(0), InOwnerTableView);
+}
+
+TSharedRef<SWidget> SDifferenceTreeRow::GenerateWidgetForColumn(const FName& ColumnName)
+{
+	const TSharedPtr<FDifference>& Diff = Item->Difference;
+	const bool bIsMessage = Diff.IsValid() && Diff->Type != EDifferenceType::Difference;
+
+	if (ColumnName == TEXT("Property"))
+	{
+		if (bIsMessage)
+		{
+			return SNew(STextBlock)
+				.Margin(CellPadding)
+				.TextStyle(FCompareVehicleBlueprintsStyle::Get(), StyleForMessage(Diff->Type))
+				.Text(FText::FromString(Diff->Message));
+		}
+
+		// groups say how much is below them, so a closed node still shows where the differences are
+		FString Label = Item->Name;
+		if (Item->HasChildren())
+		{
+			Label += "  (" + FString::FromInt(Item->GetNumDifferencesBelow()) + (Item->GetNumDifferencesBelow() == 1 ? " difference below)" : " differences below)");
+		}
+
+		return SNew(SHorizontalBox)
+
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			.VAlign(VAlign_Center)
+			[
+				SNew(SExpanderArrow, SharedThis(this))
+			]
+
+			+ SHorizontalBox::Slot()
+			.FillWidth(1.0f)
+			.VAlign(VAlign_Center)
+			[
+				SNew(STextBlock)
+				.Margin(CellPadding)
+				.Text(FText::FromString(Label))
+			];
+	}
+
+	// values only on rows which are a difference, side A on the left
+	const int32 Side = ColumnName == TEXT("Vehicle1") ? 0 : 1;
+
+	if (!Diff.IsValid() || bIsMessage || !Diff->ValuesAsString.IsValidIndex(Side))
+	{
+		return SNullWidget::NullWidget;
+	}
+
+	return SNew(STextBlock)
+		.Margin(CellPadding)
+		.TextStyle(FCompareVehicleBlueprintsStyle::Get(), "Difference.Value")
+		.Text(FText::FromString(Diff->ValuesAsString[Side]));
+}
@@ -0,0 +1,301 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "FleetCoordinator.h"
+#include "CompareVehicleBlueprints.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	constexpr int32 ReportVersion = 1;
+
+	// how often to check on running workers
+	constexpr float WorkerPollSeconds = 0.1f;
+
+	const TCHAR* TypeToString(EDifferenceType Type)
+	{
+		switch (Type)
+		{
+		case EDifferenceType::Info: return TEXT("Info");
+		case EDifferenceType::Error: return TEXT("Error");
+		case EDifferenceType::Warning: return TEXT("Warning");
+		default: return TEXT("Difference");
+		}
+	}
+
+	EDifferenceType TypeFromString(const FString& Type)
+	{
+		if (Type == TEXT("Info"))
+		{
+			return EDifferenceType::Info;
+		}
+		if (Type == TEXT("Error"))
+		{
+			return EDifferenceType::Error;
+		}
+		if (Type == TEXT("Warning"))
+		{
+			return EDifferenceType::Warning;
+		}
+		return EDifferenceType::Difference;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ToJsonArray(const TArray<FString>& Strings)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FString& String : Strings)
+		{
+			Values.Add(MakeShared<FJsonValueString>(String));
+		}
+		return Values;
+	}
+
+	FString QuoteArg(const FString& Arg)
+	{
+		return TEXT("\"") + Arg + TEXT("\"");
+	}
+}
+
+bool FFleetReport::SaveToFile(const FString& FileName) const
+{
+	TArray<TSharedPtr<FJsonValue>> VehicleValues;
+
+	for (const FFleetVehicleResult& Vehicle : Vehicles)
+	{
+		TArray<TSharedPtr<FJsonValue>> ResultValues;
+		for (const TSharedRef<FDifference>& Diff : Vehicle.Results)
+		{
+			TSharedRef<FJsonObject> ResultObject = MakeShared<FJsonObject>();
+			ResultObject->SetStringField("Type", TypeToString(Diff->Type));
+			ResultObject->SetStringField("Message", Diff->Message);
+			ResultObject->SetArrayField("Paths", ToJsonArray(Diff->Paths));
+			ResultObject->SetArrayField("Values", ToJsonArray(Diff->ValuesAsString));
+			ResultValues.Add(MakeShared<FJsonValueObject>(ResultObject));
+		}
+
+		TSharedRef<FJsonObject> VehicleObject = MakeShared<FJsonObject>();
+		VehicleObject->SetStringField("Vehicle", Vehicle.VehicleAssetPath);
+		VehicleObject->SetBoolField("Failed", Vehicle.bFailed);
+		VehicleObject->SetArrayField("Results", ResultValues);
+		VehicleValues.Add(MakeShared<FJsonValueObject>(VehicleObject));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField("Version", ReportVersion);
+	Root->SetArrayField("Vehicles", VehicleValues);
+
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	if (!FJsonSerializer::Serialize(Root, Writer))
+	{
+		return false;
+	}
+
+	return FFileHelper::SaveStringToFile(Text, *FileName, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+bool FFleetReport::LoadFromFile(const FString& FileName)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FileName))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Text);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+	{
+		return false;
+	}
+
+	if (Root->GetIntegerField("Version") != ReportVersion)
+	{
+		return false;
+	}
+
+	Vehicles.Reset();
+
+	for (const TSharedPtr<FJsonValue>& VehicleValue : Root->GetArrayField("Vehicles"))
+	{
+		const TSharedPtr<FJsonObject>& VehicleObject = VehicleValue->AsObject();
+
+		FFleetVehicleResult& Vehicle = Vehicles.AddDefaulted_GetRef();
+		Vehicle.VehicleAssetPath = VehicleObject->GetStringField("Vehicle");
+		Vehicle.bFailed = VehicleObject->GetBoolField("Failed");
+
+		for (const TSharedPtr<FJsonValue>& ResultValue : VehicleObject->GetArrayField("Results"))
+		{
+			const TSharedPtr<FJsonObject>& ResultObject = ResultValue->AsObject();
+
+			TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+			Diff->Type = TypeFromString(ResultObject->GetStringField("Type"));
+			Diff->Message = ResultObject->GetStringField("Message");
+			ResultObject->TryGetStringArrayField("Paths", Diff->Paths);
+			ResultObject->TryGetStringArrayField("Values", Diff->ValuesAsString);
+			Vehicle.Results.Add(Diff);
+		}
+	}
+
+	return true;
+}
+
+int32 FFleetReport::GetNumFailed() const
+{
+	int32 NumFailed = 0;
+	for (const FFleetVehicleResult& Vehicle : Vehicles)
+	{
+		NumFailed += Vehicle.bFailed ? 1 : 0;
+	}
+	return NumFailed;
+}
+
+FFleetCoordinator::FFleetCoordinator()
+{
+	const UCompareVehicleBlueprintsSettings* Settings = GetDefault<UCompareVehicleBlueprintsSettings>();
+
+	AssetsPerWorker = FMath::Max(Settings->FleetAssetsPerWorker, 0);
+	WorkDir = FPaths::ConvertRelativePathToFull(FPaths::Combine(FPaths::ProjectIntermediateDir(), TEXT("CompareVehicleBlueprints"), TEXT("Fleet")));
+}
+
+bool FFleetCoordinator::Run(const TArray<FString>& VehicleAssetPaths, const FString& Mode, const FString& WorkerArgs, FFleetReport& OutReport)
+{
+	OutReport.Vehicles.Reset();
+
+	if (VehicleAssetPaths.Num() == 0)
+	{
+		return true;
+	}
+
+	// files from an earlier job must not be mistaken for results of this one
+	IFileManager::Get().DeleteDirectory(*WorkDir, false, true);
+	IFileManager::Get().MakeDirectory(*WorkDir, true);
+
+	// contiguous shards of the fleet, spread evenly when there is no per worker limit
+	const int32 ShardSize = AssetsPerWorker > 0
+		? AssetsPerWorker
+		: FMath::DivideAndRoundUp(VehicleAssetPaths.Num(), FMath::Max(NumWorkers, 1));
+
+	TArray<FShard> Shards;
+	for (int32 First = 0; First < VehicleAssetPaths.Num(); First += ShardSize)
+	{
+		FShard& Shard = Shards.AddDefaulted_GetRef();
+		Shard.First = First;
+		Shard.Num = FMath::Min(ShardSize, VehicleAssetPaths.Num() - First);
+
+		const FString BaseName = FPaths::Combine(WorkDir, FString::Printf(TEXT("Shard%04d"), Shards.Num() - 1));
+		Shard.AssetListFile = BaseName + TEXT(".txt");
+		Shard.ResultFile = BaseName + TEXT(".json");
+		Shard.LogFile = BaseName + TEXT(".log");
+
+		const TArray<FString> ShardVehicles(VehicleAssetPaths.GetData() + Shard.First, Shard.Num);
+		if (!FFileHelper::SaveStringArrayToFile(ShardVehicles, *Shard.AssetListFile))
+		{
+			UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Cannot write asset list %s"), *Shard.AssetListFile);
+			return false;
+		}
+	}
+
+	UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("Running %d vehicles as %d shards on %d workers"), VehicleAssetPaths.Num(), Shards.Num(), NumWorkers);
+
+	// launch shards in order as workers become free, results are kept by shard and merged in order at the end
+	TArray<int32> ReturnCodes;
+	ReturnCodes.Init(-1, Shards.Num());
+
+	TArray<int32> Running;
+	int32 NextShard = 0;
+	int32 NumLaunched = 0;
+
+	while (NextShard < Shards.Num() || Running.Num() > 0)
+	{
+		while (NextShard < Shards.Num() && Running.Num() < FMath::Max(NumWorkers, 1))
+		{
+			if (LaunchWorker(Shards[NextShard], Mode, WorkerArgs))
+			{
+				Running.Add(NextShard);
+				++NumLaunched;
+			}
+			++NextShard;
+		}
+
+		for (int32 i = Running.Num() - 1; i >= 0; --i)
+		{
+			FShard& Shard = Shards[Running[i]];
+			if (FPlatformProcess::IsProcRunning(Shard.Process))
+			{
+				continue;
+			}
+
+			FPlatformProcess::GetProcReturnCode(Shard.Process, &ReturnCodes[Running[i]]);
+			FPlatformProcess::CloseProc(Shard.Process);
+
+			UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("Worker for vehicles %d to %d finished"), Shard.First + 1, Shard.First + Shard.Num);
+			Running.RemoveAt(i);
+		}
+
+		if (Running.Num() > 0)
+		{
+			FPlatformProcess::Sleep(WorkerPollSeconds);
+		}
+	}
+
+	for (int32 i = 0; i < Shards.Num(); ++i)
+	{
+		MergeShard(Shards[i], ReturnCodes[i], VehicleAssetPaths, OutReport);
+	}
+
+	return NumLaunched > 0;
+}
+
+bool FFleetCoordinator::LaunchWorker(FShard& Shard, const FString& Mode, const FString& WorkerArgs) const
+{
+	// the same editor and project as this process, headless
+	const FString Executable = FPlatformProcess::ExecutablePath();
+
+	const FString Args = QuoteArg(FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()))
+		+ TEXT(" -run=CompareVehicleBlueprints -Worker -Mode=") + Mode
+		+ TEXT(" -AssetList=") + QuoteArg(Shard.AssetListFile)
+		+ TEXT(" -Result=") + QuoteArg(Shard.ResultFile)
+		+ TEXT(" -abslog=") + QuoteArg(Shard.LogFile)
+		+ TEXT(" ") + WorkerArgs
+		+ TEXT(" -unattended -nosplash -nullrhi -nop4");
+
+	Shard.Process = FPlatformProcess::CreateProc(*Executable, *Args, false, true, true, nullptr, 0, nullptr, nullptr);
+
+	if (!Shard.Process.IsValid())
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Error, TEXT("Cannot start worker %s %s"), *Executable, *Args);
+		return false;
+	}
+
+	return true;
+}
+
+void FFleetCoordinator::MergeShard(const FShard& Shard, int32 ReturnCode, const TArray<FString>& VehicleAssetPaths, FFleetReport& OutReport) const
+{
+	FFleetReport ShardReport;
+	if (ShardReport.LoadFromFile(Shard.ResultFile) && ShardReport.Vehicles.Num() == Shard.Num)
+	{
+		OutReport.Vehicles.Append(MoveTemp(ShardReport.Vehicles));
+		return;
+	}
+
+	// the worker could not start, crashed or was killed, the whole shard fails
+	for (int32 i = Shard.First; i < Shard.First + Shard.Num; ++i)
+	{
+		TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+		Diff->Type = EDifferenceType::Error;
+		Diff->Message = "Worker exited with code " + FString::FromInt(ReturnCode) + " without writing results, see " + Shard.LogFile;
+
+		FFleetVehicleResult& Vehicle = OutReport.Vehicles.AddDefaulted_GetRef();
+		Vehicle.VehicleAssetPath = VehicleAssetPaths[i];
+		Vehicle.bFailed = true;
+		Vehicle.Results.Add(Diff);
+	}
+}
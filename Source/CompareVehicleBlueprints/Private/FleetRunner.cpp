@@ -0,0 +1,92 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "FleetRunner.h"
+#include "CompareVehicleBlueprints.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "HAL/PlatformMemory.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectIterator.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace
+{
+	constexpr uint64 BytesPerMegabyte = 1024 * 1024;
+}
+
+FFleetRunner::FFleetRunner()
+{
+	const UCompareVehicleBlueprintsSettings* Settings = GetDefault<UCompareVehicleBlueprintsSettings>();
+
+	WorkingSetBudget = uint64(FMath::Max(Settings->FleetWorkingSetBudgetMB, 0)) * BytesPerMegabyte;
+	MaxVehiclesPerBatch = FMath::Max(Settings->FleetMaxVehiclesPerBatch, 0);
+}
+
+void FFleetRunner::Run(const TArray<FString>& VehicleAssetPaths, TFunctionRef<void(const FString& VehicleAssetPath)> Extract)
+{
+	BeginBatch();
+
+	int32 VehiclesInBatch = 0;
+	bool bWarnedOverBudget = false;
+
+	for (int32 i = 0; i < VehicleAssetPaths.Num(); ++i)
+	{
+		Extract(VehicleAssetPaths[i]);
+		++VehiclesInBatch;
+
+		const uint64 UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+		PeakUsedPhysical = FMath::Max(PeakUsedPhysical, UsedPhysical);
+
+		const bool bOverBudget = WorkingSetBudget > 0 && UsedPhysical > WorkingSetBudget;
+		const bool bBatchFull = MaxVehiclesPerBatch > 0 && VehiclesInBatch >= MaxVehiclesPerBatch;
+		const bool bLastVehicle = i == VehicleAssetPaths.Num() - 1;
+
+		if ((bOverBudget || bBatchFull) && !bLastVehicle)
+		{
+			ReleaseBatch();
+			BeginBatch();
+			VehiclesInBatch = 0;
+
+			// if the process is still over budget with nothing from the fleet loaded the budget is too small to help
+			if (WorkingSetBudget > 0 && FPlatformMemory::GetStats().UsedPhysical > WorkingSetBudget && !bWarnedOverBudget)
+			{
+				UE_LOG(LogCompareVehicleBlueprints, Warning, TEXT("Fleet working set budget of %llu MB is below the memory used with no vehicles loaded"), WorkingSetBudget / BytesPerMegabyte);
+				bWarnedOverBudget = true;
+			}
+		}
+	}
+
+	ReleaseBatch();
+
+	UE_LOG(LogCompareVehicleBlueprints, Display, TEXT("Processed %d vehicles, released memory %d times, peak physical memory %llu MB"),
+		VehicleAssetPaths.Num(), NumReleases, PeakUsedPhysical / BytesPerMegabyte);
+}
+
+void FFleetRunner::BeginBatch()
+{
+	PackagesBeforeBatch.Reset();
+
+	for (TObjectIterator<UPackage> It; It; ++It)
+	{
+		PackagesBeforeBatch.Add(*It);
+	}
+}
+
+void FFleetRunner::ReleaseBatch()
+{
+	// detach the packages this batch loaded from their linkers so they can be collected and their files closed,
+	// packages which were already loaded or have been edited are left alone
+	for (TObjectIterator<UPackage> It; It; ++It)
+	{
+		UPackage* Package = *It;
+
+		if (!PackagesBeforeBatch.Contains(Package) && !Package->IsDirty())
+		{
+			ResetLoaders(Package);
+		}
+	}
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	PackagesBeforeBatch.Reset();
+	++NumReleases;
+}
@@ -0,0 +1,255 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "FleetSubtreeIndex.h"
+#include "VehicleCompareImpl.h"
+#include "Hash/CityHash.h"
+#include "ChaosWheeledVehicleMovementComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+
+namespace
+{
+	// hashes must be the same in every process so results from separate runs can be merged
+	uint64 HashBytes(const void* Data, int32 NumBytes)
+	{
+		return CityHash64(static_cast<const char*>(Data), NumBytes);
+	}
+
+	uint64 HashString(const FString& String)
+	{
+		return HashBytes(*String, String.Len() * sizeof(TCHAR));
+	}
+
+	uint64 CombineHashes(uint64 A, uint64 B)
+	{
+		const uint64 Pair[2] = { A, B };
+		return HashBytes(Pair, sizeof(Pair));
+	}
+}
+
+void FFleetSubtreeIndex::AddVehicle(const FString& VehicleAssetPath, const FVehicleComponents& Components)
+{
+	for (const UChaosWheeledVehicleMovementComponent* Component : Components.VehicleMovementComponents)
+	{
+		AddComponent(VehicleAssetPath, UChaosWheeledVehicleMovementComponent::StaticClass(), Component);
+	}
+
+	for (const USkeletalMeshComponent* Component : Components.SkeletalMeshComponents)
+	{
+		AddComponent(VehicleAssetPath, USkeletalMeshComponent::StaticClass(), Component);
+	}
+}
+
+void FFleetSubtreeIndex::AddComponent(const FString& VehicleAssetPath, UClass* Class, const UObject* Component)
+{
+	if (!Component) return;
+
+	// add the component record first so its children can refer to it
+	const int32 RecordIndex = Records.AddDefaulted();
+	const FString Path = Component->GetName();
+
+	uint64 Hash = HashString(Class->GetName());
+	int32 Size = 0;
+
+	for (TFieldIterator<FProperty> It(Class); It; ++It)
+	{
+		const FProperty* Property = *It;
+
+		if (Property->HasAnyPropertyFlags(EPropertyFlags::CPF_Edit))
+		{
+			int32 ChildSize = 0;
+			const uint64 ChildHash = HashValue(VehicleAssetPath, Path + "." + Property->GetName(), RecordIndex, Property, Property->ContainerPtrToValuePtr<uint8>(Component), ChildSize);
+
+			Hash = CombineHashes(Hash, CombineHashes(HashString(Property->GetName()), ChildHash));
+			Size += ChildSize;
+		}
+	}
+
+	FSubtreeRecord& Record = Records[RecordIndex];
+	Record.VehicleAssetPath = VehicleAssetPath;
+	Record.Path = Path;
+	Record.TypeName = Class->GetName();
+	Record.Hash = Hash;
+	Record.Size = Size;
+}
+
+uint64 FFleetSubtreeIndex::HashValue(const FString& VehicleAssetPath, const FString& Path, int32 ParentRecord, const FProperty* Property, const uint8* PropertyAddr, int32& OutSize)
+{
+	if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property))
+	{
+		const int32 RecordIndex = Records.AddDefaulted();
+		const FString TypeName = StructProperty->Struct->GetName();
+
+		uint64 Hash = HashString(TypeName);
+		int32 Size = 0;
+
+		for (FProperty* Prop = StructProperty->Struct->PropertyLink; Prop != nullptr; Prop = Prop->PropertyLinkNext)
+		{
+			int32 ChildSize = 0;
+			const uint64 ChildHash = HashValue(VehicleAssetPath, Path + "." + Prop->GetName(), RecordIndex, Prop, Prop->ContainerPtrToValuePtr<uint8>(PropertyAddr, 0), ChildSize);
+
+			Hash = CombineHashes(Hash, CombineHashes(HashString(Prop->GetName()), ChildHash));
+			Size += ChildSize;
+		}
+
+		// records are referred to by index, the array may have grown since RecordIndex was added
+		FSubtreeRecord& Record = Records[RecordIndex];
+		Record.VehicleAssetPath = VehicleAssetPath;
+		Record.Path = Path;
+		Record.TypeName = TypeName;
+		Record.Hash = Hash;
+		Record.Size = Size;
+		Record.ParentRecord = ParentRecord;
+
+		OutSize = Size;
+		return Hash;
+	}
+
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		const int32 RecordIndex = Records.AddDefaulted();
+		const FString TypeName = "TArray<" + ArrayProperty->Inner->GetCPPType() + ">";
+
+		FScriptArrayHelper ArrayHelper(ArrayProperty, PropertyAddr);
+
+		uint64 Hash = CombineHashes(HashString(TypeName), ArrayHelper.Num());
+		int32 Size = 0;
+
+		for (int32 i = 0; i < ArrayHelper.Num(); ++i)
+		{
+			int32 ChildSize = 0;
+			Hash = CombineHashes(Hash, HashValue(VehicleAssetPath, Path + "[" + FString::FromInt(i) + "]", RecordIndex, ArrayProperty->Inner, ArrayHelper.GetRawPtr(i), ChildSize));
+			Size += ChildSize;
+		}
+
+		FSubtreeRecord& Record = Records[RecordIndex];
+		Record.VehicleAssetPath = VehicleAssetPath;
+		Record.Path = Path;
+		Record.TypeName = TypeName;
+		Record.Hash = Hash;
+		Record.Size = Size;
+		Record.ParentRecord = ParentRecord;
+
+		OutSize = Size;
+		return Hash;
+	}
+
+	OutSize = 1;
+
+	// plain numbers are hashed from memory, bools can be bitfields so read them through the property
+	if (const FBoolProperty* BoolProperty = CastField<FBoolProperty>(Property))
+	{
+		const uint8 Value = BoolProperty->GetPropertyValue(PropertyAddr) ? 1 : 0;
+		return HashBytes(&Value, sizeof(Value));
+	}
+
+	if (Property->IsA<FNumericProperty>() || Property->IsA<FEnumProperty>())
+	{
+		return HashBytes(PropertyAddr, Property->ElementSize);
+	}
+
+	// names, strings, text and object references are hashed from their exported text, which is the same in every process
+	FString Value;
+	Property->ExportTextItem_Direct(Value, PropertyAddr, nullptr, nullptr, PPF_None);
+	return HashString(Value);
+}
+
+TArray<FDuplicateSubtreeGroup> FFleetSubtreeIndex::FindDuplicates(int32 MinVehicles, int32 MinSize) const
+{
+	// group records with the same type and contents
+	TMap<TPair<FString, uint64>, int32> GroupIndices;
+	TArray<FDuplicateSubtreeGroup> Groups;
+	TArray<int32> RecordGroups;
+	RecordGroups.Init(INDEX_NONE, Records.Num());
+
+	for (int32 RecordIndex = 0; RecordIndex < Records.Num(); ++RecordIndex)
+	{
+		const FSubtreeRecord& Record = Records[RecordIndex];
+		if (Record.Size < MinSize)
+		{
+			continue;
+		}
+
+		const TPair<FString, uint64> Key(Record.TypeName, Record.Hash);
+
+		int32 GroupIndex;
+		if (const int32* Found = GroupIndices.Find(Key))
+		{
+			GroupIndex = *Found;
+		}
+		else
+		{
+			GroupIndex = Groups.AddDefaulted();
+			Groups[GroupIndex].TypeName = Record.TypeName;
+			Groups[GroupIndex].Hash = Record.Hash;
+			Groups[GroupIndex].Size = Record.Size;
+			GroupIndices.Add(Key, GroupIndex);
+		}
+
+		Groups[GroupIndex].Members.Add(&Record);
+		RecordGroups[RecordIndex] = GroupIndex;
+	}
+
+	for (FDuplicateSubtreeGroup& Group : Groups)
+	{
+		TSet<FString> Vehicles;
+		for (const FSubtreeRecord* Member : Group.Members)
+		{
+			Vehicles.Add(Member->VehicleAssetPath);
+		}
+		Group.NumVehicles = Vehicles.Num();
+	}
+
+	auto IsShared = [&](int32 GroupIndex)
+	{
+		return GroupIndex != INDEX_NONE && Groups[GroupIndex].NumVehicles >= MinVehicles;
+	};
+
+	// a group only repeats its parent's group when every member's parent is in that one shared group and nothing else is
+	auto IsRedundant = [&](int32 GroupIndex)
+	{
+		const FDuplicateSubtreeGroup& Group = Groups[GroupIndex];
+		int32 ParentGroup = INDEX_NONE;
+
+		for (const FSubtreeRecord* Member : Group.Members)
+		{
+			const int32 MemberParentGroup = Member->ParentRecord != INDEX_NONE ? RecordGroups[Member->ParentRecord] : INDEX_NONE;
+
+			if (!IsShared(MemberParentGroup) || (ParentGroup != INDEX_NONE && MemberParentGroup != ParentGroup))
+			{
+				return false;
+			}
+
+			ParentGroup = MemberParentGroup;
+		}
+
+		return ParentGroup != INDEX_NONE && Groups[ParentGroup].Members.Num() == Group.Members.Num();
+	};
+
+	TArray<FDuplicateSubtreeGroup> Duplicates;
+
+	for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex)
+	{
+		if (IsShared(GroupIndex) && !IsRedundant(GroupIndex))
+		{
+			Duplicates.Add(Groups[GroupIndex]);
+		}
+	}
+
+	for (FDuplicateSubtreeGroup& Group : Duplicates)
+	{
+		Group.Members.Sort([](const FSubtreeRecord& A, const FSubtreeRecord& B)
+		{
+			return A.VehicleAssetPath != B.VehicleAssetPath ? A.VehicleAssetPath < B.VehicleAssetPath : A.Path < B.Path;
+		});
+	}
+
+	// the most duplicated data first
+	Duplicates.Sort([](const FDuplicateSubtreeGroup& A, const FDuplicateSubtreeGroup& B)
+	{
+		const int64 SavingA = int64(A.Size) * (A.Members.Num() - 1);
+		const int64 SavingB = int64(B.Size) * (B.Members.Num() - 1);
+		return SavingA != SavingB ? SavingA > SavingB : A.TypeName < B.TypeName;
+	});
+
+	return Duplicates;
+}
@@ -8,8 +8,16 @@
 #include "UIInputData.h"
 #include "ThumbnailRendering/ThumbnailManager.h"
 #include "VehicleCompareImpl.h"
+#include "VehicleCompareSubsystem.h"
+#include "Editor.h"
 #include "DifferenceTile.h"
 #include "Widgets/Layout/SScrollBox.h"
+#include "DifferencePropagator.h"
+#include "ContentBrowserModule.h"
+#include "IContentBrowserSingleton.h"
+#include "Widgets/Input/SCheckBox.h"
+#include "Widgets/Views/STreeView.h"
+#include "Widgets/Notifications/SProgressBar.h"
 
 namespace {
 #define LOCTEXT_NAMESPACE "CompareVehicleBlueprints"
@@ -111,34 +119,11 @@ void SMainWindow::Construct(const FArguments& Args, TSharedPtr < FInputData >& I
 						InputData->VehicleAssetPaths[i] = AssetData.GetObjectPathString();
 					}
 				})
-				.OnShouldFilterAsset_Lambda( [](const FAssetData & AssetData)->bool 
+				.OnShouldFilterAsset_Lambda( [this](const FAssetData & AssetData)->bool 
 				{
-					// does the blueprint create something which derives from AWheeledVehiclePawn
-					if (AssetData.IsValid() )
-					{
-						if (AssetData.AssetClassPath.ToString() == "/Script/Engine.Blueprint")
-						{
-							UBlueprint* BlueprintAsset = Cast<UBlueprint>(AssetData.GetAsset());
-							if (BlueprintAsset)
-							{
-								if (BlueprintAsset->ParentClass == AWheeledVehiclePawn::StaticClass())
-								{
-									return false;
-								}
-
-								if (BlueprintAsset->GeneratedClass)
-								{
-									const UObject* CDO = BlueprintAsset->GeneratedClass->GetDefaultObject();
-									const AWheeledVehiclePawn* Pawn = Cast< AWheeledVehiclePawn >(CDO);
-									if (Pawn)
-									{
-										return false;
-									}
-								}
-							}
-						}
-					}
-					return true;
+					// does the blueprint create something which derives from AWheeledVehiclePawn, decided from
+					// asset registry tags so the picker does not load every blueprint in the project
+					return !VehicleAssetFilter.IsWheeledVehicleBlueprint(AssetData);
 				})
 			]
 		];
@@ -177,7 +162,8 @@ void SMainWindow::Construct(const FArguments& Args, TSharedPtr < FInputData >& I
 					.VAlign(VAlign_Center)
 					.IsEnabled_Lambda([this]() -> bool
 					{
-							return InputData->VehicleAssetPaths[0] != "" &&
+							return !Preparation.IsValid() &&
+								InputData->VehicleAssetPaths[0] != "" &&
 								InputData->VehicleAssetPaths[1] != "" &&
 								InputData->VehicleAssetPaths[0] != InputData->VehicleAssetPaths[1];
 					})
@@ -192,6 +178,56 @@ void SMainWindow::Construct(const FArguments& Args, TSharedPtr < FInputData >& I
 			]
 		]
 
+		+SHorizontalBox::Slot()
+		.HAlign(HAlign_Right)
+		.VAlign(VAlign_Center)
+		.AutoWidth()
+		[
+			SNew(SBox)
+			.MinDesiredWidth(OverrideValueButtonColumnWidth)
+			[
+				SNew(SVerticalBox)
+				+ SVerticalBox::Slot()
+				.AutoHeight()
+				.VAlign(VAlign_Top)
+				.Padding(12.0)
+				[
+					SNew(SButton)
+					.HAlign(HAlign_Center)
+					.VAlign(VAlign_Center)
+					.IsEnabled_Raw(this, &SMainWindow::CanCopySelected)
+					.ToolTipText(LOCTEXT("CopySelectedTooltip", "Copy the vehicle 1 values of the selected rows to the vehicle blueprints selected in the content browser, or to vehicle 2 if none are selected"))
+					.ContentPadding(FMargin(4.0f, 4.0f))
+					.OnClicked_Raw(this, &SMainWindow::OnCopySelectedButtonClicked)
+					[
+						SNew(STextBlock)
+						.Text(LOCTEXT("CopySelectedButton", "Copy Selected Values"))
+						.Margin(2.0f)
+					]
+				]
+			]
+		]
+
+		+ SHorizontalBox::Slot()
+		.AutoWidth()
+		.VAlign(VAlign_Center)
+		.Padding(12.0)
+		[
+			SNew(SCheckBox)
+			.IsChecked_Lambda([this]() -> ECheckBoxState
+			{
+				return bShowTree ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+			})
+			.OnCheckStateChanged_Lambda([this](ECheckBoxState State)
+			{
+				bShowTree = State == ECheckBoxState::Checked;
+			})
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("TreeViewCheckBox", "Tree View"))
+			]
+		]
+
 		+ SHorizontalBox::Slot()
 		[
 			SNew(SSpacer)
@@ -199,17 +235,62 @@ void SMainWindow::Construct(const FArguments& Args, TSharedPtr < FInputData >& I
 
 	];
 
-	// list of results
+	// progress while vehicles are loaded over several frames
 	VerticalBox->AddSlot()
+	.AutoHeight()
+	.Padding(10, 5)
 	[
-		SNew(SScrollBox)
-		+SScrollBox::Slot()
-		.Padding(10, 5)
+		SNew(SHorizontalBox)
+		.Visibility_Lambda([this]() { return Preparation.IsValid() ? EVisibility::Visible : EVisibility::Collapsed; })
+
+		+ SHorizontalBox::Slot()
+		.FillWidth(1.0f)
+		.VAlign(VAlign_Center)
+		[
+			SNew(SProgressBar)
+			.Percent_Lambda([this]() { return TOptional<float>(PreparationProgress); })
+		]
+
+		+ SHorizontalBox::Slot()
+		.AutoWidth()
+		.VAlign(VAlign_Center)
+		.Padding(12.0f, 0.0f)
+		[
+			SNew(STextBlock)
+			.Text_Lambda([this]() { return PreparationStatus; })
+		]
+
+		+ SHorizontalBox::Slot()
+		.AutoWidth()
+		.VAlign(VAlign_Center)
+		[
+			SNew(SButton)
+			.ContentPadding(FMargin(4.0f, 4.0f))
+			.OnClicked_Lambda([this]()
+			{
+				if (Preparation.IsValid())
+				{
+					Preparation->Cancel();
+				}
+				return FReply::Handled();
+			})
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("CancelPreparationButton", "Cancel"))
+			]
+		]
+	];
+
+	// list of results, it scrolls itself so only the visible rows get widgets
+	VerticalBox->AddSlot()
+	.Padding(10, 5)
+	[
+		SNew(SBox)
+		.Visibility_Lambda([this]() { return bShowTree ? EVisibility::Collapsed : EVisibility::Visible; })
 		[
 			SAssignNew(ListViewWidget,SListView< TSharedRef< FDifference >>)
-			.ItemHeight(24)
 			.ListItemsSource(&Results)
-			.SelectionMode(ESelectionMode::None)
+			.SelectionMode(ESelectionMode::Multi)
 			.ListViewStyle(FAppStyle::Get(), "SimpleListView")
 			.OnGenerateRow(this, &SMainWindow::OnGenerateRow)
 			.HeaderRow(
@@ -230,22 +311,223 @@ void SMainWindow::Construct(const FArguments& Args, TSharedPtr < FInputData >& I
 			)
 		]
 	];
+
+	// tree of results, only the expanded nodes exist
+	VerticalBox->AddSlot()
+	.Padding(10, 5)
+	[
+		SAssignNew(TreeViewWidget, STreeView< TSharedRef< FDifferenceTreeNode >>)
+		.Visibility_Lambda([this]() { return bShowTree ? EVisibility::Visible : EVisibility::Collapsed; })
+		.TreeItemsSource(&TreeRoots)
+		.SelectionMode(ESelectionMode::Single)
+		.OnGenerateRow(this, &SMainWindow::OnGenerateTreeRow)
+		.OnGetChildren_Lambda([](TSharedRef<FDifferenceTreeNode> Node, TArray<TSharedRef<FDifferenceTreeNode>>& OutChildren)
+		{
+			OutChildren = Node->GetChildren();
+		})
+		.HeaderRow(
+
+			SNew(SHeaderRow)
+			+ SHeaderRow::Column("Property")
+			.FillWidth(0.5)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Property")))
+			]
+			+ SHeaderRow::Column("Vehicle1")
+			.FillWidth(0.25)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Vehicle 1")))
+			]
+			+ SHeaderRow::Column("Vehicle2")
+			.FillWidth(0.25)
+			[
+				SNew(STextBlock)
+				.Text(FText::FromString(TEXT("Vehicle 2")))
+			]
+		)
+	];
+
+	// stats footer
+	VerticalBox->AddSlot()
+	.AutoHeight()
+	.Padding(10, 5)
+	[
+		SNew(STextBlock)
+		.Text_Lambda([this]() { return StatsText; })
+	];
+}
+
+void SMainWindow::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+
+	constexpr double StatsUpdateSeconds = 0.5;
+
+	StatsPaintSeconds += SDifferenceTile::ConsumePaintSeconds();
+	StatsElapsedSeconds += InDeltaTime;
+	++StatsFrames;
+
+	if (StatsElapsedSeconds < StatsUpdateSeconds)
+	{
+		return;
+	}
+
+	const double PaintMillisecondsPerFrame = 1000.0 * StatsPaintSeconds / StatsFrames;
+
+	StatsText = FText::FromString(FString::FromInt(Results.Num()) + " results, "
+		+ FString::FromInt(SDifferenceTile::GetNumLiveWidgets()) + " row widgets, "
+		+ FString::Printf(TEXT("%.3f"), PaintMillisecondsPerFrame) + " ms painting rows per frame");
+
+	StatsPaintSeconds = 0.0;
+	StatsElapsedSeconds = 0.0;
+	StatsFrames = 0;
 }
 
 
 FReply SMainWindow::OnCompareButtonClicked()
 {
-	UVehicleCompareImpl* Impl = NewObject<UVehicleCompareImpl>();
+	StartPreparation(InputData->VehicleAssetPaths, [this](FVehiclePreparation& Prepared)
+	{
+		if (Prepared.IsCancelled())
+		{
+			return;
+		}
+
+		const TArray<FVehicleComponents>& Vehicles = Prepared.GetVehicles();
+
+		if (Prepared.GetMessages().Num() > 0)
+		{
+			Results = Prepared.GetMessages();
+		}
+		else
+		{
+			// the subsystem's comparer keeps what it learned about the classes from the last click
+			UVehicleCompareSubsystem* CompareSubsystem = GEditor ? GEditor->GetEditorSubsystem<UVehicleCompareSubsystem>() : nullptr;
+			if (!CompareSubsystem)
+			{
+				return;
+			}
+
+			Results = CompareSubsystem->CompareVehicleComponents(Vehicles[0], Vehicles[1]);
+
+			ResultsSourceVehicle = Vehicles[0].AssetPath;
+		}
+
+		RefreshResults();
+	});
 
-	Impl->CompareVehicleBlueprints(InputData->VehicleAssetPaths[0], InputData->VehicleAssetPaths[1]);
+	return FReply::Handled();
+}
 
-	Results = Impl->GetResults();
+void SMainWindow::StartPreparation(const TArray<FString>& VehicleAssetPaths, FVehiclePreparation::FOnFinished OnFinished)
+{
+	PreparationProgress = 0.0f;
+	PreparationStatus = FText::GetEmpty();
+
+	Preparation = FVehiclePreparation::Start(VehicleAssetPaths,
+		[this](float Progress, const FString& Status)
+		{
+			PreparationProgress = Progress;
+			PreparationStatus = FText::FromString(Status);
+		},
+		[this, OnFinished = MoveTemp(OnFinished)](FVehiclePreparation& Prepared)
+		{
+			OnFinished(Prepared);
+
+			// the preparation keeps itself alive until it returns
+			Preparation.Reset();
+		});
+}
 
+void SMainWindow::RefreshResults()
+{
 	if (ListViewWidget.IsValid())
 	{
 		ListViewWidget->RequestListRefresh();
 	}
 
+	// the tree shares one sorted copy of the results, nodes below the top level are made on expansion
+	TSharedRef<TArray<TSharedRef<FDifference>>> SortedResults = MakeShared<TArray<TSharedRef<FDifference>>>(Results);
+	FDifferenceTreeNode::SortForTree(*SortedResults);
+
+	TreeRoots = FDifferenceTreeNode::MakeRoot(SortedResults)->GetChildren();
+
+	if (TreeViewWidget.IsValid())
+	{
+		TreeViewWidget->RequestTreeRefresh();
+	}
+}
+
+bool SMainWindow::CanCopySelected() const
+{
+	if (!ListViewWidget.IsValid() || Preparation.IsValid())
+	{
+		return false;
+	}
+
+	for (const TSharedRef<FDifference>& Diff : ListViewWidget->GetSelectedItems())
+	{
+		if (!Diff->Component.IsNone())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+FReply SMainWindow::OnCopySelectedButtonClicked()
+{
+	// every vehicle blueprint selected in the content browser, vehicle 2 when there are none
+	TArray<FAssetData> SelectedAssets;
+	FContentBrowserModule& ContentBrowserModule = FModuleManager::LoadModuleChecked<FContentBrowserModule>("ContentBrowser");
+	ContentBrowserModule.Get().GetSelectedAssets(SelectedAssets);
+
+	TArray<FString> Targets;
+	for (const FAssetData& AssetData : SelectedAssets)
+	{
+		if (VehicleAssetFilter.IsWheeledVehicleBlueprint(AssetData))
+		{
+			Targets.Add(AssetData.GetObjectPathString());
+		}
+	}
+
+	if (Targets.Num() == 0)
+	{
+		Targets.Add(InputData->VehicleAssetPaths[1]);
+	}
+
+	// the source first, then the targets
+	TArray<FString> VehicleAssetPaths = { ResultsSourceVehicle };
+	VehicleAssetPaths.Append(Targets);
+
+	StartPreparation(VehicleAssetPaths, [this, Selected = ListViewWidget->GetSelectedItems()](FVehiclePreparation& Prepared)
+	{
+		if (Prepared.IsCancelled())
+		{
+			return;
+		}
+
+		TArray<TSharedRef<FDifference>> Messages = Prepared.GetMessages();
+
+		TArray<FVehicleComponents> Vehicles = Prepared.GetVehicles();
+		const FVehicleComponents Source = Vehicles[0];
+		Vehicles.RemoveAt(0);
+
+		if (Source.Blueprint)
+		{
+			FDifferencePropagator Propagator;
+			Propagator.Apply(Source, Selected, Vehicles, Messages);
+		}
+
+		// the values shown are now out of date for the targets, the messages say what was changed
+		Results.Append(Messages);
+
+		RefreshResults();
+	});
+
 	return FReply::Handled();
 }
 
@@ -256,3 +538,9 @@ TSharedRef<ITableRow> SMainWindow::OnGenerateRow(TSharedRef<FDifference> InItem,
 		.InItem(InItem);
 }
 
+TSharedRef<ITableRow> SMainWindow::OnGenerateTreeRow(TSharedRef<FDifferenceTreeNode> InItem, const TSharedRef<STableViewBase>& OwnerTable)
+{
+	return SNew(SDifferenceTreeRow, OwnerTable)
+		.InItem(InItem);
+}
+
@@ -0,0 +1,935 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+
+#include "PropertyComparer.h"
+#include "UObject/UnrealType.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "Misc/ScopeExit.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Curves/CurveFloat.h"
+#include "GenericPlatform/GenericPlatformMath.h"
+#include "ComparisonMemory.h"
+#include "Misc/ScopeRWLock.h"
+
+//error C4456 declaration of 'TypedProperty' hides previous local declaration
+
+#pragma warning( disable: 4456 )
+#pragma warning( disable: 4457 )
+
+namespace
+{
+	const FString Quote = "\"";
+
+	// compare FRuntimeFloatCurve values by resampling both curves, reported as a single row
+	void CompareCurves(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* CurveAddrA, const uint8* CurveAddrB)
+	{
+		const FRichCurve* CurveA = reinterpret_cast<const FRuntimeFloatCurve*>(CurveAddrA)->GetRichCurveConst();
+		const FRichCurve* CurveB = reinterpret_cast<const FRuntimeFloatCurve*>(CurveAddrB)->GetRichCurveConst();
+
+		const int32 NumKeysA = CurveA ? CurveA->GetNumKeys() : 0;
+		const int32 NumKeysB = CurveB ? CurveB->GetNumKeys() : 0;
+
+		if (NumKeysA == 0 && NumKeysB == 0)
+		{
+			return;
+		}
+
+		auto Describe = [](const FRichCurve* Curve, int32 NumKeys) -> FString
+		{
+			if (NumKeys == 0)
+			{
+				return "no keys";
+			}
+
+			float MinTime, MaxTime;
+			Curve->GetTimeRange(MinTime, MaxTime);
+			return FString::FromInt(NumKeys) + " keys, " + FString::SanitizeFloat(MinTime) + " to " + FString::SanitizeFloat(MaxTime);
+		};
+
+		if (NumKeysA == 0 || NumKeysB == 0)
+		{
+			Comparer.Report(Context, PathA, PathB, "Curve", Property, Describe(CurveA, NumKeysA), Describe(CurveB, NumKeysB));
+			return;
+		}
+
+		// sample both curves on a shared grid covering both time ranges
+		float MinTimeA, MaxTimeA, MinTimeB, MaxTimeB;
+		CurveA->GetTimeRange(MinTimeA, MaxTimeA);
+		CurveB->GetTimeRange(MinTimeB, MaxTimeB);
+
+		const float MinTime = FMath::Min(MinTimeA, MinTimeB);
+		const float MaxTime = FMath::Max(MaxTimeA, MaxTimeB);
+
+		constexpr int32 MinSamples = 64;
+		constexpr int32 MaxSamples = 1024;
+		const int32 NumSamples = Align(FMath::Clamp(8 * FMath::Max(NumKeysA, NumKeysB), MinSamples, MaxSamples), 4);
+
+		// up to three 4KB arrays for every curve which differs, often on several workers at once
+		FMemMark Mark(FMemStack::Get());
+
+		TScratchArray<float> Times;
+		TScratchArray<float> ValuesA;
+		TScratchArray<float> ValuesB;
+		Times.SetNumUninitialized(NumSamples);
+		ValuesA.SetNumUninitialized(NumSamples);
+		ValuesB.SetNumUninitialized(NumSamples);
+
+		const float Step = (MaxTime - MinTime) / (NumSamples - 1);
+		float PeakValue = 1.0f;
+
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			Times[i] = MinTime + Step * i;
+			ValuesA[i] = CurveA->Eval(Times[i]);
+			ValuesB[i] = CurveB->Eval(Times[i]);
+			PeakValue = FMath::Max3(PeakValue, FMath::Abs(ValuesA[i]), FMath::Abs(ValuesB[i]));
+		}
+
+		// deviation statistics four samples at a time
+		VectorRegister4Float MaxDeviation4 = VectorZeroFloat();
+		VectorRegister4Float SumSquares4 = VectorZeroFloat();
+
+		for (int32 i = 0; i < NumSamples; i += 4)
+		{
+			const VectorRegister4Float Delta = VectorSubtract(VectorLoad(&ValuesA[i]), VectorLoad(&ValuesB[i]));
+			MaxDeviation4 = VectorMax(MaxDeviation4, VectorAbs(Delta));
+			SumSquares4 = VectorMultiplyAdd(Delta, Delta, SumSquares4);
+		}
+
+		alignas(16) float MaxDeviations[4];
+		alignas(16) float SumSquares[4];
+		VectorStoreAligned(MaxDeviation4, MaxDeviations);
+		VectorStoreAligned(SumSquares4, SumSquares);
+
+		const float MaxDeviation = FMath::Max(FMath::Max(MaxDeviations[0], MaxDeviations[1]), FMath::Max(MaxDeviations[2], MaxDeviations[3]));
+		const float Rms = FMath::Sqrt((SumSquares[0] + SumSquares[1] + SumSquares[2] + SumSquares[3]) / NumSamples);
+
+		// keys can differ without changing the shape, e.g. an extra key on a straight line
+		const float Tolerance = 1.e-5f * PeakValue;
+		if (MaxDeviation <= Tolerance)
+		{
+			return;
+		}
+
+		int32 MaxIndex = 0;
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			if (FMath::Abs(ValuesA[i] - ValuesB[i]) >= MaxDeviation)
+			{
+				MaxIndex = i;
+				break;
+			}
+		}
+
+		const FString Deviation = ", max deviation " + FString::SanitizeFloat(MaxDeviation) + " at " + FString::SanitizeFloat(Times[MaxIndex])
+			+ " (" + FString::SanitizeFloat(ValuesA[MaxIndex]) + " vs " + FString::SanitizeFloat(ValuesB[MaxIndex]) + "), RMS " + FString::SanitizeFloat(Rms);
+
+		Comparer.Report(Context, PathA, PathB, "Curve", Property, Describe(CurveA, NumKeysA), Describe(CurveB, NumKeysB) + Deviation);
+	}
+}
+
+FPropertyComparer::FPropertyComparer()
+{
+	// curves are compared by value over their time range, comparing the keys one by one reports every key after an inserted one
+	RegisterStructComparer(FRuntimeFloatCurve::StaticStruct(), &CompareCurves);
+}
+
+void FPropertyComparer::ApplySettings(const UCompareVehicleBlueprintsSettings& Settings)
+{
+	Filter.Compile(Settings);
+
+	bParallelTraversal = Settings.bParallelTraversal;
+	MinParallelTraversalSize = Settings.MinParallelTraversalSize;
+}
+
+void FPropertyComparer::RegisterStructComparer(const UScriptStruct* Struct, FStructComparer Comparer)
+{
+	StructComparers.Add(Struct, Comparer);
+}
+
+int32 FPropertyComparer::CompareObjects(const FString& PathA, const FString& PathB, UClass* Class, const UObject* A, const UObject* B, IPropertyCompareSink& Sink, FName Component, FName SkipProperty)
+{
+	const FClassLayout& Layout = GetClassLayout(Class);
+
+	FMemMark Mark(FMemStack::Get());
+
+	// first pick the properties which need a full comparison, this is cheap so stays on the game thread
+	TScratchArray<FProperty*> ToCompare;
+
+	FPropertyCompareContext TopLevelContext;
+
+	for (FProperty* Property : Layout.EditProperties)
+	{
+		if (Property->GetFName() == SkipProperty || IsFilteredOut(TopLevelContext, Property))
+		{
+			continue;
+		}
+
+		// most properties are still at the class default on both objects, then A and B must be identical
+		// so the full comparison can be skipped. Only the union of the two deltas from the defaults is compared
+		if (bUseArchetypePrefilter && Layout.Defaults)
+		{
+			const bool bDefaultA = Property->Identical_InContainer(A, Layout.Defaults);
+			const bool bDefaultB = Property->Identical_InContainer(B, Layout.Defaults);
+
+			if (bDefaultA && bDefaultB)
+			{
+				continue;
+			}
+		}
+
+		ToCompare.Add(Property);
+	}
+
+	CompareTopLevel(PathA, PathB, ToCompare, A, B, Component, Sink);
+
+	return ToCompare.Num();
+}
+
+void FPropertyComparer::CompareStructs(const FString& PathA, const FString& PathB, const UStruct* Struct, const void* A, const void* B, IPropertyCompareSink& Sink)
+{
+	if (!Struct) return;
+
+	CacheRoots.Add(Struct);
+
+	FMemMark Mark(FMemStack::Get());
+
+	TScratchArray<FProperty*> ToCompare;
+
+	FPropertyCompareContext TopLevelContext;
+
+	for (FProperty* Property = Struct->PropertyLink; Property != nullptr; Property = Property->PropertyLinkNext)
+	{
+		if (!IsFilteredOut(TopLevelContext, Property))
+		{
+			ToCompare.Add(Property);
+		}
+	}
+
+	CompareTopLevel(PathA, PathB, ToCompare, A, B, NAME_None, Sink);
+}
+
+void FPropertyComparer::CompareTopLevel(const FString& PathA, const FString& PathB, TConstArrayView<FProperty*> Properties, const void* A, const void* B, FName Component, IPropertyCompareSink& Sink)
+{
+	LLM_SCOPE_BYTAG(CompareVehicleBlueprints);
+
+	FMemMark Mark(FMemStack::Get());
+
+	TScratchArray<int32> Weights;
+	int32 TotalWeight = 0;
+
+	for (const FProperty* Property : Properties)
+	{
+		const int32 Weight = EstimateSubtreeSize(Property, Property->ContainerPtrToValuePtr<uint8>(A), Property->ContainerPtrToValuePtr<uint8>(B));
+
+		Weights.Add(Weight);
+		TotalWeight += Weight;
+	}
+
+	// the subtree below each top-level property is independent, so each one gets its own result buffer and
+	// the buffers are merged in declaration order afterwards. The output is the same however the work is split
+	TScratchArray<FPropertyCompareContext> Contexts;
+	Contexts.SetNum(Properties.Num());
+
+	// differences found on a component can be copied between blueprints, they remember which template they are on
+	for (FPropertyCompareContext& Context : Contexts)
+	{
+		Context.Component = Component;
+	}
+
+	auto CompareTopLevelProperty = [&](int32 Index)
+	{
+		FProperty* Property = Properties[Index];
+
+		const uint8* PropertyAddrA = Property->ContainerPtrToValuePtr<uint8>(A);
+		const uint8* PropertyAddrB = Property->ContainerPtrToValuePtr<uint8>(B);
+
+		CompareProperty(Contexts[Index], PathA, PathB, Property, PropertyAddrA, PropertyAddrB);
+	};
+
+	const int32 NumWorkers = FMath::Min(FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, Properties.Num());
+
+	if (bParallelTraversal && NumWorkers > 1 && TotalWeight >= MinParallelTraversalSize)
+	{
+		// largest subtrees first, each to the least loaded worker
+		TScratchArray<int32> Order;
+		for (int32 Index = 0; Index < Properties.Num(); ++Index)
+		{
+			Order.Add(Index);
+		}
+		Order.Sort([&Weights](int32 Left, int32 Right) { return Weights[Left] > Weights[Right]; });
+
+		TScratchArray<TScratchArray<int32>> WorkerItems;
+		TScratchArray<int32> WorkerLoads;
+		WorkerItems.SetNum(NumWorkers);
+		WorkerLoads.SetNumZeroed(NumWorkers);
+
+		for (const int32 Index : Order)
+		{
+			int32 Worker = 0;
+			for (int32 Candidate = 1; Candidate < NumWorkers; ++Candidate)
+			{
+				if (WorkerLoads[Candidate] < WorkerLoads[Worker])
+				{
+					Worker = Candidate;
+				}
+			}
+
+			WorkerItems[Worker].Add(Index);
+			WorkerLoads[Worker] += Weights[Index];
+		}
+
+		ParallelFor(NumWorkers, [&](int32 Worker)
+		{
+			// tags and scratch memory are per thread
+			LLM_SCOPE_BYTAG(CompareVehicleBlueprints);
+			FMemMark WorkerMark(FMemStack::Get());
+
+			for (const int32 Index : WorkerItems[Worker])
+			{
+				CompareTopLevelProperty(Index);
+			}
+		});
+	}
+	else
+	{
+		for (int32 Index = 0; Index < Properties.Num(); ++Index)
+		{
+			CompareTopLevelProperty(Index);
+		}
+	}
+
+	for (const FPropertyCompareContext& Context : Contexts)
+	{
+		for (const TSharedRef<FDifference>& Difference : Context.Results)
+		{
+			Sink.OnDifference(Difference);
+		}
+	}
+}
+
+void FPropertyComparer::Report(FPropertyCompareContext& Context, FString PathA, FString PathB, const FString& Type, const FProperty* Property, const FString& StringValueA, const FString& StringValueB)
+{
+	if (!Property) return;
+
+	PathA = AppendDisplayName(PathA, Property);
+	PathB = AppendDisplayName(PathB, Property);
+
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = EDifferenceType::Difference;
+	Diff->Paths.Add(PathA);
+	Diff->Paths.Add(PathB);
+	Diff->ValuesAsString.Add(StringValueA);
+	Diff->ValuesAsString.Add(StringValueB);
+	Diff->Component = Context.Component;
+	Diff->PropertyPath = Context.GetPropertyPathString();
+	Context.Results.Add(Diff);
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FEnumProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	UEnum* EnumDef = Property->GetEnum();
+	FNumericProperty* UnderlyingProperty = Property->GetUnderlyingProperty();
+	check(UnderlyingProperty);
+	int32 IntValueA = UnderlyingProperty->GetSignedIntPropertyValue(PropertyAddrA);
+	int32 IntValueB = UnderlyingProperty->GetSignedIntPropertyValue(PropertyAddrB);
+
+	if (IntValueA != IntValueB)
+	{
+		const FString StringValueA = GetEnumValueString(EnumDef, IntValueA);
+		const FString StringValueB = GetEnumValueString(EnumDef, IntValueB);
+
+		Report(Context, PathA, PathB, "Enum", Property, StringValueA, StringValueB);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FBoolProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	const bool ValueA = Property->GetPropertyValue(PropertyAddrA);
+	const bool ValueB = Property->GetPropertyValue(PropertyAddrB);
+	if (ValueA != ValueB)
+	{
+		FString StringValueA = ValueA ? TEXT("true") : TEXT("false");
+		FString StringValueB = ValueB ? TEXT("true") : TEXT("false");
+
+		Report(Context, PathA, PathB, "Bool", Property, StringValueA, StringValueB);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FNumericProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	// see if it's an enum
+	UEnum* EnumDef = Property->GetIntPropertyEnum();
+	if (EnumDef)
+	{
+		// export enums as strings
+		int32 IntValueA = Property->GetSignedIntPropertyValue(PropertyAddrA);
+		int32 IntValueB = Property->GetSignedIntPropertyValue(PropertyAddrB);
+
+		if (IntValueA != IntValueB)
+		{
+			const FString StringValueA = GetEnumValueString(EnumDef, IntValueA);
+			const FString StringValueB = GetEnumValueString(EnumDef, IntValueB);
+
+			Report(Context, PathA, PathB, "Numeric/Enum", Property, StringValueA, StringValueB);
+		}
+	}
+	else if (Property->IsFloatingPoint())
+	{
+		const FString StringValueA = FString::SanitizeFloat(Property->GetFloatingPointPropertyValue(PropertyAddrA));
+		const FString StringValueB = FString::SanitizeFloat(Property->GetFloatingPointPropertyValue(PropertyAddrB));
+		if (StringValueA != StringValueB)
+		{
+			Report(Context, PathA, PathB, "Numeric/float", Property, StringValueA, StringValueB);
+		}
+	}
+	else if (Property->IsInteger())
+	{
+		const FString StringValueA = FString::FromInt(Property->GetSignedIntPropertyValue(PropertyAddrA));
+		const FString StringValueB = FString::FromInt(Property->GetSignedIntPropertyValue(PropertyAddrB));
+		if (StringValueA != StringValueB)
+		{
+			Report(Context, PathA, PathB, "Numeric/int", Property, StringValueA, StringValueB);
+		}
+	}
+	else
+	{
+		AddMessage(Context, "No comparison done for Numeric/Unknown property " + Property->GetName(), EDifferenceType::Error);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FStrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	const FString StringValueA = Property->GetPropertyValue(PropertyAddrA);
+	const FString StringValueB = Property->GetPropertyValue(PropertyAddrB);
+	if (StringValueA != StringValueB)
+	{
+		Report(Context, PathA, PathB, "String", Property, Quote + StringValueA + Quote, Quote + StringValueB + Quote);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FClassProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	auto A = Property->GetPropertyValue(PropertyAddrA);
+	auto B = Property->GetPropertyValue(PropertyAddrB);
+	if (A != B)
+	{
+		FString StringValueA = A ? A->GetName() : "NULL";
+		FString StringValueB = B ? B->GetName() : "NULL";
+
+		// different objects can share a name, show where they live
+		if (A && B && StringValueA == StringValueB)
+		{
+			StringValueA = A->GetPathName();
+			StringValueB = B->GetPathName();
+		}
+
+		Report(Context, PathA, PathB, "Class", Property, StringValueA, StringValueB);
+	}
+}
+
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FTextProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	const FString StringValueA = Property->GetPropertyValue(PropertyAddrA).ToString();
+	const FString StringValueB = Property->GetPropertyValue(PropertyAddrB).ToString();
+	if (StringValueA != StringValueB)
+	{
+		Report(Context, PathA, PathB, "Text", Property, Quote + StringValueA + Quote, Quote + StringValueB + Quote);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FNameProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	const FString StringValueA = Property->GetPropertyValue(PropertyAddrA).ToString();
+	const FString StringValueB = Property->GetPropertyValue(PropertyAddrB).ToString();
+	if (StringValueA != StringValueB)
+	{
+		Report(Context, PathA, PathB, "Name", Property, Quote + StringValueA + Quote, Quote + StringValueB + Quote);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FObjectPtrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	auto A = Property->GetPropertyValue(PropertyAddrA);
+	auto B = Property->GetPropertyValue(PropertyAddrB);
+	if (A != B)
+	{
+		FString StringValueA = A ? A->GetName() : "NULL";
+		FString StringValueB = B ? B->GetName() : "NULL";
+
+		// different objects can share a name, show where they live
+		if (A && B && StringValueA == StringValueB)
+		{
+			StringValueA = A->GetPathName();
+			StringValueB = B->GetPathName();
+		}
+
+		Report(Context, PathA, PathB, "Object", Property, StringValueA, StringValueB);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FSoftObjectProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	FSoftObjectPtr A = Property->GetPropertyValue(PropertyAddrA);
+	FSoftObjectPtr B = Property->GetPropertyValue(PropertyAddrB);
+	const FString StringValueA = A.ToString();
+	const FString StringValueB = B.ToString();
+	if (StringValueA != StringValueB)
+	{
+		Report(Context, PathA, PathB, "SoftObject", Property, StringValueA, StringValueB);
+	}
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FStructProperty* StructProperty, const uint8* StructAddrA, const uint8* StructAddrB)
+{
+	if (!StructProperty) return;
+
+	UScriptStruct* Struct = StructProperty->Struct;
+
+	if (const FStructComparer* Comparer = StructComparers.Find(Struct))
+	{
+		(*Comparer)(*this, Context, PathA, PathB, StructProperty, StructAddrA, StructAddrB);
+		return;
+	}
+
+	if (Struct)
+	{
+		const FString PathAEx = PathA + "/" + Struct->GetName();
+		const FString PathBEx = PathB + "/" + Struct->GetName();
+
+		for (FProperty* Prop = Struct->PropertyLink; Prop != nullptr; Prop = Prop->PropertyLinkNext)
+		{
+			if (IsFilteredOut(Context, Prop))
+			{
+				continue;
+			}
+
+			const uint8* PropertyAddrA = Prop->ContainerPtrToValuePtr<uint8>(StructAddrA, 0);
+			const uint8* PropertyAddrB = Prop->ContainerPtrToValuePtr<uint8>(StructAddrB, 0);
+
+			CompareProperty(Context, PathAEx, PathBEx, Prop, PropertyAddrA, PropertyAddrB);
+		}
+	}
+}
+
+void FPropertyComparer::CompareStructField(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const UScriptStruct* Struct, FName FieldName, const uint8* StructAddrA, const uint8* StructAddrB)
+{
+	FProperty* Field = Struct->FindPropertyByName(FieldName);
+	if (!Field || IsFilteredOut(Context, Field))
+	{
+		return;
+	}
+
+	CompareProperty(Context, PathA, PathB, Field, Field->ContainerPtrToValuePtr<uint8>(StructAddrA), Field->ContainerPtrToValuePtr<uint8>(StructAddrB));
+}
+
+void FPropertyComparer::Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FArrayProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	FScriptArrayHelper ArrayHelperA(Property, PropertyAddrA);
+	FScriptArrayHelper ArrayHelperB(Property, PropertyAddrB);
+
+	if (ArrayHelperA.Num() != ArrayHelperB.Num())
+	{
+		const FString PathAEx = AppendDisplayName(PathA, Property);
+		const FString PathBEx = AppendDisplayName(PathB, Property);
+
+		FString Message = PathAEx + " has " + FString::FromInt(ArrayHelperA.Num()) + " elements, " + PathBEx + " has " + FString::FromInt( ArrayHelperB.Num() );
+		AddMessage(Context, Message, EDifferenceType::Warning);
+	}
+
+	// this is the array type 
+	if (Property->Inner)
+	{
+		// need to test all the things it might be an array of 
+		if (FStructProperty* StructProperty = CastField<FStructProperty>(Property->Inner))
+		{
+			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+
+			for (int32 i = 0; i < MinI; ++i)
+			{
+				const uint8* StructAddressA = ArrayHelperA.GetRawPtr(i);
+				const uint8* StructAddressB = ArrayHelperB.GetRawPtr(i);
+				if (StructProperty->Identical(StructAddressA, StructAddressB, PPF_None))
+				{
+					continue;
+				}
+
+				Context.ArrayIndices.Last() = i;
+
+				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
+				const FString PathAEx = PathA + Suffix;
+				const FString PathBEx = PathB + Suffix;
+
+				Compare(Context, PathAEx, PathBEx, StructProperty, StructAddressA, StructAddressB);
+			}
+		}
+		else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property->Inner))
+		{
+			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+
+			for (int32 i = 0; i < MinI; ++i)
+			{
+				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
+				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
+				if (Property->Inner->Identical(DataAddressA, DataAddressB, PPF_None))
+				{
+					continue;
+				}
+
+				Context.ArrayIndices.Last() = i;
+
+				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
+				const FString PathAEx = PathA + Suffix;
+				const FString PathBEx = PathB + Suffix;
+
+				Compare(Context, PathAEx, PathBEx, NumericProperty, DataAddressA, DataAddressB);
+			}
+		}
+		else if (FNameProperty* NameProperty = CastField<FNameProperty>(Property->Inner))
+		{
+			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+
+			for (int32 i = 0; i < MinI; ++i)
+			{
+				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
+				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
+				if (Property->Inner->Identical(DataAddressA, DataAddressB, PPF_None))
+				{
+					continue;
+				}
+
+				Context.ArrayIndices.Last() = i;
+
+				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
+				const FString PathAEx = PathA + Suffix;
+				const FString PathBEx = PathB + Suffix;
+
+				Compare(Context, PathAEx, PathBEx, NameProperty, DataAddressA, DataAddressB);
+			}
+		}
+		else if (FObjectPtrProperty* ObjectProperty = CastField<FObjectPtrProperty>(Property->Inner))
+		{
+			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+
+			for (int32 i = 0; i < MinI; ++i)
+			{
+				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
+				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
+				if (Property->Inner->Identical(DataAddressA, DataAddressB, PPF_None))
+				{
+					continue;
+				}
+
+				Context.ArrayIndices.Last() = i;
+
+				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
+				const FString PathAEx = PathA + Suffix;
+				const FString PathBEx = PathB + Suffix;
+
+				Compare(Context, PathAEx, PathBEx, ObjectProperty, DataAddressA, DataAddressB);
+			}
+		}
+		else if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property->Inner))
+		{
+			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+
+			for (int32 i = 0; i < MinI; ++i)
+			{
+				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
+				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
+				if (Property->Inner->Identical(DataAddressA, DataAddressB, PPF_None))
+				{
+					continue;
+				}
+
+				Context.ArrayIndices.Last() = i;
+
+				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
+				const FString PathAEx = PathA + Suffix;
+				const FString PathBEx = PathB + Suffix;
+
+				Compare(Context, PathAEx, PathBEx, EnumProperty, DataAddressA, DataAddressB);
+			}
+		}
+		else
+		{
+			AddMessage(Context, "No comparison done for " + Property->Inner->GetClass()->GetName(), EDifferenceType::Error);
+		}
+	}
+}
+
+const FPropertyComparer::FClassLayout& FPropertyComparer::GetClassLayout(UClass* Class)
+{
+	if (const FClassLayout* Layout = ClassLayouts.Find(Class))
+	{
+		return *Layout;
+	}
+
+	CacheRoots.Add(Class);
+
+	FClassLayout& Layout = ClassLayouts.Add(Class);
+	Layout.Defaults = Class->GetDefaultObject();
+
+	for (TFieldIterator<FProperty> It(Class); It; ++It)
+	{
+		FProperty* Property = *It;
+
+		if (Property->HasAnyPropertyFlags(EPropertyFlags::CPF_Edit))
+		{
+			Layout.EditProperties.Add(Property);
+		}
+	}
+
+	return Layout;
+}
+
+void FPropertyComparer::FlushCaches()
+{
+	ClassLayouts.Reset();
+	StructSizes.Reset();
+	CacheRoots.Reset();
+
+	FWriteScopeLock WriteLock(CacheLock);
+	DisplayNames.Reset();
+	EnumValueStrings.Reset();
+}
+
+bool FPropertyComparer::HasStaleCaches() const
+{
+	for (const TWeakObjectPtr<const UStruct>& Root : CacheRoots)
+	{
+		if (!Root.IsValid())
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+FString FPropertyComparer::AppendDisplayName(const FString& Path, const FProperty* Property)
+{
+	if (!Property)
+	{
+		return Path;
+	}
+
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const FString* Cached = DisplayNames.Find(Property))
+		{
+			return Path + "/" + *Cached;
+		}
+	}
+
+	FString DisplayName = Property->GetDisplayNameText().ToString();
+	FString Name = Property->GetName();
+
+	if (DisplayName != Name)
+	{
+		if (DisplayName.Contains(" "))
+		{
+			DisplayName = "\"" + DisplayName + "\"";
+		}
+
+		Name = DisplayName;
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+	DisplayNames.Add(Property, Name);
+
+	return Path + "/" + Name;
+}
+
+FString FPropertyComparer::GetEnumValueString(const UEnum* Enum, int64 Value)
+{
+	const TPair<const UEnum*, int64> Key(Enum, Value);
+
+	{
+		FReadScopeLock ReadLock(CacheLock);
+		if (const FString* Cached = EnumValueStrings.Find(Key))
+		{
+			return *Cached;
+		}
+	}
+
+	FString StringValue = Enum->GetAuthoredNameStringByValue(Value);
+
+	// for "Engine.Windows Target Settings.Default RHI", GetAuthoredNameStringByValue() returns "DefaultGraphicsRHI_DX12" which
+	// is derived from the enum, but the UI displays "DirectX 12" from the 
+	// metadata of the enum, declared like so:
+	//UENUM()
+	//enum class EDefaultGraphicsRHI : uint8
+	//{
+	//	DefaultGraphicsRHI_Default = 0 UMETA(DisplayName = "Default"),
+	//	DefaultGraphicsRHI_DX11 = 1 UMETA(DisplayName = "DirectX 11"),
+	//	DefaultGraphicsRHI_DX12 = 2 UMETA(DisplayName = "DirectX 12"),
+	// 
+
+	const FText DisplayName = Enum->GetDisplayNameTextByIndex(static_cast<int32>(Value));
+
+	if (!DisplayName.IsEmpty() && DisplayName.ToString() != StringValue)
+	{
+		StringValue = DisplayName.ToString() + "(" + StringValue + ")";
+	}
+
+	FWriteScopeLock WriteLock(CacheLock);
+	EnumValueStrings.Add(Key, StringValue);
+
+	return StringValue;
+}
+
+int32 FPropertyComparer::EstimateStaticSize(const FProperty* Property)
+{
+	const FStructProperty* StructProperty = CastField<FStructProperty>(Property);
+	if (!StructProperty)
+	{
+		return 1;
+	}
+
+	if (const int32* Cached = StructSizes.Find(StructProperty->Struct))
+	{
+		return *Cached;
+	}
+
+	int32 Size = 1;
+	for (FProperty* Prop = StructProperty->Struct->PropertyLink; Prop != nullptr; Prop = Prop->PropertyLinkNext)
+	{
+		Size += EstimateStaticSize(Prop);
+	}
+
+	StructSizes.Add(StructProperty->Struct, Size);
+	return Size;
+}
+
+int32 FPropertyComparer::EstimateSubtreeSize(const FProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper ArrayHelperA(ArrayProperty, PropertyAddrA);
+		FScriptArrayHelper ArrayHelperB(ArrayProperty, PropertyAddrB);
+
+		return 1 + FMath::Max(ArrayHelperA.Num(), ArrayHelperB.Num()) * EstimateStaticSize(ArrayProperty->Inner);
+	}
+
+	return EstimateStaticSize(Property);
+}
+
+void FPropertyComparer::AddMessage(FPropertyCompareContext& Context, const FString& Message, const EDifferenceType& Type)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = Type;
+	Diff->Message = Message;
+	Context.Results.Add(Diff);
+}
+
+FString FPropertyCompareContext::GetPropertyPathString() const
+{
+	// the syntax PropertyPathHelpers resolves, e.g. "WheelSetups[2].BoneName"
+	FString Result;
+
+	for (int32 i = 0; i < PropertyPath.Num(); ++i)
+	{
+		if (i > 0)
+		{
+			Result += ".";
+		}
+
+		Result += PropertyPath[i].ToString();
+
+		if (ArrayIndices.IsValidIndex(i) && ArrayIndices[i] != INDEX_NONE)
+		{
+			Result += "[" + FString::FromInt(ArrayIndices[i]) + "]";
+		}
+	}
+
+	return Result;
+}
+
+bool FPropertyComparer::IsFilteredOut(FPropertyCompareContext& Context, const FProperty* Property) const
+{
+	if (Filter.IsEmpty())
+	{
+		return false;
+	}
+
+	Context.PropertyPath.Add(Property->GetFName());
+	const bool bExcluded = Filter.IsExcluded(Context.PropertyPath, Property);
+	Context.PropertyPath.Pop(false);
+
+	return bExcluded;
+}
+
+bool FPropertyComparer::IsStructFieldFilteredOut(FPropertyCompareContext& Context, const UScriptStruct* Struct, FName FieldName) const
+{
+	const FProperty* Field = Struct->FindPropertyByName(FieldName);
+	return !Field || IsFilteredOut(Context, Field);
+}
+
+void FPropertyComparer::CompareProperty(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+{
+	Context.PropertyPath.Add(Property->GetFName());
+	Context.ArrayIndices.Add(INDEX_NONE);
+	ON_SCOPE_EXIT
+	{
+		Context.PropertyPath.Pop(false);
+		Context.ArrayIndices.Pop(false);
+	};
+
+	// native identity check first, the typed comparisons below extract and format values so only run them on a mismatch
+	if (Property->Identical(PropertyAddrA, PropertyAddrB, PPF_None))
+	{
+		return;
+	}
+
+	// cast to every possible class, thats the way its done in the engine
+	if (FEnumProperty* TypedProperty = CastField<FEnumProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FBoolProperty* TypedProperty = CastField<FBoolProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FNumericProperty* TypedProperty = CastField<FNumericProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FStrProperty* TypedProperty = CastField<FStrProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FTextProperty* TypedProperty = CastField<FTextProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FArrayProperty* TypedProperty = CastField<FArrayProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FStructProperty* TypedProperty = CastField<FStructProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FClassProperty* TypedProperty = CastField<FClassProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FNameProperty* TypedProperty = CastField<FNameProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FObjectPtrProperty* TypedProperty = CastField<FObjectPtrProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else if (FSoftObjectProperty* TypedProperty = CastField<FSoftObjectProperty>(Property))
+	{
+		Compare(Context, PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+	}
+	else {
+		AddMessage(Context, "No comparison done for property " + Property->GetName(), EDifferenceType::Error);
+	}
+}
@@ -0,0 +1,288 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "PropertyFilter.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+	const FString AnyDepth = "**";
+
+	bool IsWildcard(const FString& Segment)
+	{
+		int32 Index;
+		return Segment.FindChar(TEXT('*'), Index) || Segment.FindChar(TEXT('?'), Index);
+	}
+
+	// properties the traversal descends into, so a rule can match something below them. An array is one if its elements are
+	bool HasPropertiesBelow(const FProperty* Property)
+	{
+		if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			return HasPropertiesBelow(ArrayProperty->Inner);
+		}
+
+		return CastField<FStructProperty>(Property) || CastField<FObjectPropertyBase>(Property);
+	}
+}
+
+void FPropertyFilter::Compile(const UCompareVehicleBlueprintsSettings& Settings)
+{
+	Include.Reset();
+	Exclude.Reset();
+
+	for (const FString& Pattern : Settings.IncludePaths)
+	{
+		Include.Add(Pattern);
+	}
+
+	for (const FString& Pattern : Settings.ExcludePaths)
+	{
+		Exclude.Add(Pattern);
+	}
+
+	ExcludeCategories = Settings.ExcludeCategories;
+
+	ExcludeFlags = CPF_None;
+	if (Settings.bExcludeAdvancedDisplay)
+	{
+		ExcludeFlags |= CPF_AdvancedDisplay;
+	}
+	if (Settings.bExcludeTransient)
+	{
+		ExcludeFlags |= CPF_Transient;
+	}
+
+	ExcludedByFlags.Reset();
+}
+
+bool FPropertyFilter::IsEmpty() const
+{
+	return Include.IsEmpty() && Exclude.IsEmpty() && ExcludeCategories.IsEmpty() && ExcludeFlags == CPF_None;
+}
+
+bool FPropertyFilter::IsExcluded(TConstArrayView<FName> Path, const FProperty* Property) const
+{
+	if (IsExcludedByFlags(Property))
+	{
+		return true;
+	}
+
+	if (!Exclude.IsEmpty() && Exclude.Match(Path) == FPathTrie::EMatch::Full)
+	{
+		return true;
+	}
+
+	// with include rules only visit properties inside an included path, or on the way down to one. A leaf has
+	// nothing below it, so unless a rule matches it a partial match is not enough. This is also what stops "**",
+	// which could always match something deeper, from keeping every property
+	if (!Include.IsEmpty())
+	{
+		const FPathTrie::EMatch Match = Include.Match(Path);
+
+		if (Match == FPathTrie::EMatch::None || (Match == FPathTrie::EMatch::Partial && !HasPropertiesBelow(Property)))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool FPropertyFilter::IsExcludedByFlags(const FProperty* Property) const
+{
+	if (ExcludeFlags == CPF_None && ExcludeCategories.IsEmpty())
+	{
+		return false;
+	}
+
+	{
+		FReadScopeLock ReadLock(ExcludedByFlagsLock);
+		if (const bool* Cached = ExcludedByFlags.Find(Property))
+		{
+			return *Cached;
+		}
+	}
+
+	bool bExcluded = Property->HasAnyPropertyFlags(ExcludeFlags);
+
+	if (!bExcluded && !ExcludeCategories.IsEmpty())
+	{
+		const FString& Category = Property->GetMetaData(TEXT("Category"));
+
+		for (const FString& Excluded : ExcludeCategories)
+		{
+			if (Category == Excluded || Category.StartsWith(Excluded + "|"))
+			{
+				bExcluded = true;
+				break;
+			}
+		}
+	}
+
+	FWriteScopeLock WriteLock(ExcludedByFlagsLock);
+	ExcludedByFlags.Add(Property, bExcluded);
+	return bExcluded;
+}
+
+void FPropertyFilter::FPathTrie::Reset()
+{
+	Nodes.Reset();
+	Nodes.AddDefaulted();
+}
+
+void FPropertyFilter::FPathTrie::Add(const FString& Pattern)
+{
+	if (Nodes.Num() == 0)
+	{
+		Reset();
+	}
+
+	TArray<FString> Segments;
+	Pattern.ParseIntoArray(Segments, TEXT("."));
+
+	if (Segments.Num() == 0)
+	{
+		return;
+	}
+
+	// nodes are referred to by index because adding a node can reallocate the array
+	int32 Node = 0;
+
+	for (FString& Segment : Segments)
+	{
+		Segment.TrimStartAndEndInline();
+
+		int32 Next = INDEX_NONE;
+
+		if (Segment == AnyDepth)
+		{
+			Next = Nodes[Node].AnyDepthChild;
+			if (Next == INDEX_NONE)
+			{
+				Next = Nodes.AddDefaulted();
+				Nodes[Next].bIsAnyDepth = true;
+				Nodes[Node].AnyDepthChild = Next;
+			}
+		}
+		else if (IsWildcard(Segment))
+		{
+			for (const TPair<FString, int32>& Child : Nodes[Node].WildcardChildren)
+			{
+				if (Child.Key == Segment)
+				{
+					Next = Child.Value;
+					break;
+				}
+			}
+
+			if (Next == INDEX_NONE)
+			{
+				Next = Nodes.AddDefaulted();
+				Nodes[Node].WildcardChildren.Emplace(Segment, Next);
+			}
+		}
+		else
+		{
+			const FName Name(*Segment);
+			if (const int32* Child = Nodes[Node].Children.Find(Name))
+			{
+				Next = *Child;
+			}
+			else
+			{
+				Next = Nodes.AddDefaulted();
+				Nodes[Node].Children.Add(Name, Next);
+			}
+		}
+
+		Node = Next;
+	}
+
+	Nodes[Node].bTerminal = true;
+}
+
+void FPropertyFilter::FPathTrie::AddState(int32 Node, TScratchArray<int32>& States) const
+{
+	if (States.Contains(Node))
+	{
+		return;
+	}
+
+	States.Add(Node);
+
+	// "**" can match no names at all
+	if (Nodes[Node].AnyDepthChild != INDEX_NONE)
+	{
+		AddState(Nodes[Node].AnyDepthChild, States);
+	}
+}
+
+FPropertyFilter::FPathTrie::EMatch FPropertyFilter::FPathTrie::Match(TConstArrayView<FName> Path) const
+{
+	if (IsEmpty())
+	{
+		return EMatch::None;
+	}
+
+	// this runs for every property visited, the state lists are scratch on this thread
+	FMemMark Mark(FMemStack::Get());
+
+	// walk the trie keeping every node the path so far can be at
+	TScratchArray<int32> Current;
+	TScratchArray<int32> Next;
+
+	AddState(0, Current);
+
+	for (const FName& Segment : Path)
+	{
+		Next.Reset();
+
+		FString SegmentString;
+
+		for (const int32 State : Current)
+		{
+			const FNode& Node = Nodes[State];
+
+			if (Node.bIsAnyDepth)
+			{
+				AddState(State, Next);
+			}
+
+			if (const int32* Child = Node.Children.Find(Segment))
+			{
+				AddState(*Child, Next);
+			}
+
+			for (const TPair<FString, int32>& Child : Node.WildcardChildren)
+			{
+				if (SegmentString.IsEmpty())
+				{
+					SegmentString = Segment.ToString();
+				}
+
+				if (SegmentString.MatchesWildcard(Child.Key))
+				{
+					AddState(Child.Value, Next);
+				}
+			}
+		}
+
+		if (Next.Num() == 0)
+		{
+			return EMatch::None;
+		}
+
+		for (const int32 State : Next)
+		{
+			if (Nodes[State].bTerminal)
+			{
+				return EMatch::Full;
+			}
+		}
+
+		Swap(Current, Next);
+	}
+
+	return EMatch::Partial;
+}
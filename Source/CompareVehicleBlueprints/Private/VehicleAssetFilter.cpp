@@ -0,0 +1,124 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "VehicleAssetFilter.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Engine/Blueprint.h"
+#include "Misc/PackageName.h"
+#include "WheeledVehiclePawn.h"
+
+namespace
+{
+	// blueprints deriving from blueprints, stop following parents past this depth in case of a broken chain
+	constexpr int32 MaxParentDepth = 32;
+
+	const FString GeneratedClassSuffix = "_C";
+
+	// tags hold export text such as /Script/CoreUObject.Class'/Script/ChaosVehicles.WheeledVehiclePawn'
+	FString TagToObjectPath(const FString& TagValue)
+	{
+		return FPackageName::ExportTextPathToObjectPath(TagValue);
+	}
+}
+
+bool FVehicleAssetFilter::IsWheeledVehicleBlueprint(const FAssetData& AssetData)
+{
+	if (!AssetData.IsValid())
+	{
+		return false;
+	}
+
+	if (AssetData.AssetClassPath != UBlueprint::StaticClass()->GetClassPathName())
+	{
+		return false;
+	}
+
+	// the first native class in the hierarchy is enough to know if it derives from AWheeledVehiclePawn
+	FString NativeParentClass;
+	if (AssetData.GetTagValue(FBlueprintTags::NativeParentClassPath, NativeParentClass))
+	{
+		return IsWheeledVehicleClass(TagToObjectPath(NativeParentClass), 0);
+	}
+
+	// older assets only have the direct parent
+	FString ParentClass;
+	if (AssetData.GetTagValue(FBlueprintTags::ParentClassPath, ParentClass))
+	{
+		return IsWheeledVehicleClass(TagToObjectPath(ParentClass), 0);
+	}
+
+	return false;
+}
+
+TArray<FString> FVehicleAssetFilter::FindWheeledVehicleBlueprints(const TArray<FString>& PackagePaths, const FString& NameFilter)
+{
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UBlueprint::StaticClass()->GetClassPathName());
+	Filter.bRecursivePaths = true;
+
+	for (const FString& PackagePath : PackagePaths)
+	{
+		Filter.PackagePaths.Add(FName(*PackagePath));
+	}
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	TArray<FString> VehicleAssetPaths;
+
+	for (const FAssetData& AssetData : Assets)
+	{
+		if (!NameFilter.IsEmpty() && !AssetData.AssetName.ToString().MatchesWildcard(NameFilter))
+		{
+			continue;
+		}
+
+		if (IsWheeledVehicleBlueprint(AssetData))
+		{
+			VehicleAssetPaths.Add(AssetData.GetObjectPathString());
+		}
+	}
+
+	VehicleAssetPaths.Sort();
+	return VehicleAssetPaths;
+}
+
+bool FVehicleAssetFilter::IsWheeledVehicleClass(const FString& ClassPath, int32 Depth)
+{
+	if (ClassPath.IsEmpty() || Depth > MaxParentDepth)
+	{
+		return false;
+	}
+
+	if (const bool* Cached = ClassResults.Find(ClassPath))
+	{
+		return *Cached;
+	}
+
+	bool bIsVehicle = false;
+
+	// native classes are always loaded, blueprint generated classes are only found if something already loaded them
+	if (const UClass* Class = FindObject<UClass>(nullptr, *ClassPath))
+	{
+		bIsVehicle = Class->IsChildOf(AWheeledVehiclePawn::StaticClass());
+	}
+	else if (ClassPath.EndsWith(GeneratedClassSuffix))
+	{
+		// the parent is another blueprint, follow its tags: /Game/Cars/BP_Base.BP_Base_C is generated by /Game/Cars/BP_Base.BP_Base
+		const FString BlueprintPath = ClassPath.LeftChop(GeneratedClassSuffix.Len());
+
+		IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+		const FAssetData ParentData = AssetRegistry.GetAssetByObjectPath(FSoftObjectPath(BlueprintPath));
+
+		FString ParentClass;
+		if (ParentData.IsValid() && ParentData.GetTagValue(FBlueprintTags::ParentClassPath, ParentClass))
+		{
+			bIsVehicle = IsWheeledVehicleClass(TagToObjectPath(ParentClass), Depth + 1);
+		}
+	}
+
+	ClassResults.Add(ClassPath, bIsVehicle);
+	return bIsVehicle;
+}
@@ -10,13 +10,20 @@
 #include "InputAction.h"
 #include "UObject\UnrealType.h"
 #include "UObject/NoExportTypes.h"
-#include "SubobjectDataSubsystem.h"
-#include "SubobjectDataBlueprintFunctionLibrary.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
 #include "ChaosWheeledVehicleMovementComponent.h"
 #include "GenericPlatform/GenericPlatformMath.h"
 #include "UObject\UnrealTypePrivate.h"
 #include "Difference.h"
 #include "ReferenceSkeleton.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "BlueprintGraphComparer.h"
+#include "ComparisonMemory.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+#include "PhysicsEngine/PhysicsConstraintTemplate.h"
 
 //error C4456 declaration of 'TypedProperty' hides previous local declaration
 
@@ -25,372 +32,335 @@
 
 namespace
 {
-	const FString Quote = "\"";
+	// collision shapes within this distance (cm) or angle (degrees) are treated as the same
+	constexpr float GeometryTolerance = 0.01f;
 
-	FString AppendDisplayName(const FString& Path, const FProperty* Property)
+	// "3.5 -> 3.2 (-8.6%)"
+	FString FormatChange(float A, float B)
 	{
-		if (!Property)
+		FString Result = FString::SanitizeFloat(A) + " -> " + FString::SanitizeFloat(B);
+		if (A != 0.0f)
 		{
-			return Path;
+			Result += FString::Printf(TEXT(" (%+.1f%%)"), 100.0f * (B - A) / FMath::Abs(A));
 		}
+		return Result;
+	}
 
-		FString DisplayName = Property->GetDisplayNameText().ToString();
-		FString Name = Property->GetName();
+	// comparisons written for the Chaos vehicle structs, which read fields directly and explain what a difference means
+	void CompareEngineConfig(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* StructAddrA, const uint8* StructAddrB)
+	{
+		const FVehicleEngineConfig& A = *reinterpret_cast<const FVehicleEngineConfig*>(StructAddrA);
+		const FVehicleEngineConfig& B = *reinterpret_cast<const FVehicleEngineConfig*>(StructAddrB);
+		const UScriptStruct* Struct = FVehicleEngineConfig::StaticStruct();
 
-		if (DisplayName != Name)
+		const FString PathAEx = PathA + "/" + Struct->GetName();
+		const FString PathBEx = PathB + "/" + Struct->GetName();
+
+		auto Field = [&](bool bDifferent, FName FieldName)
 		{
-			if (DisplayName.Contains(" "))
+			if (bDifferent)
 			{
-				DisplayName = "\"" + DisplayName + "\"";
+				Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, FieldName, StructAddrA, StructAddrB);
 			}
+		};
 
-			Name = DisplayName;
-		}
+		Field(A.MaxTorque != B.MaxTorque, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, MaxTorque));
+		Field(A.MaxRPM != B.MaxRPM, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, MaxRPM));
+		Field(A.EngineIdleRPM != B.EngineIdleRPM, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, EngineIdleRPM));
+		Field(A.EngineBrakeEffect != B.EngineBrakeEffect, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, EngineBrakeEffect));
+		Field(A.EngineRevUpMOI != B.EngineRevUpMOI, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, EngineRevUpMOI));
+		Field(A.EngineRevDownRate != B.EngineRevDownRate, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, EngineRevDownRate));
 
-		return Path + "/" + Name;
-	}
+		// the curve compares itself, identical curves return straight away
+		Field(true, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, TorqueCurve));
 
+		// the torque curve is normalized, peak torque and the rev range are what set the power
+		const bool bTorque = A.MaxTorque != B.MaxTorque && !Comparer.IsStructFieldFilteredOut(Context, Struct, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, MaxTorque));
+		const bool bRPM = A.MaxRPM != B.MaxRPM && !Comparer.IsStructFieldFilteredOut(Context, Struct, GET_MEMBER_NAME_CHECKED(FVehicleEngineConfig, MaxRPM));
 
-}
+		if (bTorque || bRPM)
+		{
+			Comparer.AddMessage(Context, PathAEx + ": max torque " + FormatChange(A.MaxTorque, B.MaxTorque) + ", max RPM " + FormatChange(A.MaxRPM, B.MaxRPM), EDifferenceType::Info);
+		}
+	}
 
-void UVehicleCompareImpl::Report(FString PathA, FString PathB, const FString& Type, const FProperty* Property, const FString& StringValueA, const FString& StringValueB)
-{
-	if (!Property) return;
+	void CompareTransmissionConfig(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* StructAddrA, const uint8* StructAddrB)
+	{
+		const FVehicleTransmissionConfig& A = *reinterpret_cast<const FVehicleTransmissionConfig*>(StructAddrA);
+		const FVehicleTransmissionConfig& B = *reinterpret_cast<const FVehicleTransmissionConfig*>(StructAddrB);
+		const UScriptStruct* Struct = FVehicleTransmissionConfig::StaticStruct();
 
-	PathA = AppendDisplayName(PathA, Property);
-	PathB = AppendDisplayName(PathB, Property);
+		const FString PathAEx = PathA + "/" + Struct->GetName();
+		const FString PathBEx = PathB + "/" + Struct->GetName();
 
-	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
-	Diff->Type = EDifferenceType::Difference;
-	Diff->Paths.Add(PathA);
-	Diff->Paths.Add(PathB);
-	Diff->ValuesAsString.Add(StringValueA);
-	Diff->ValuesAsString.Add(StringValueB);
-	Results.Add(Diff);
-}
+		auto Field = [&](bool bDifferent, FName FieldName)
+		{
+			if (bDifferent)
+			{
+				Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, FieldName, StructAddrA, StructAddrB);
+			}
+		};
+
+		Field(A.bUseAutomaticGears != B.bUseAutomaticGears, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, bUseAutomaticGears));
+		Field(A.bUseAutoReverse != B.bUseAutoReverse, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, bUseAutoReverse));
+		Field(A.FinalRatio != B.FinalRatio, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, FinalRatio));
+		Field(A.ForwardGearRatios != B.ForwardGearRatios, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, ForwardGearRatios));
+		Field(A.ReverseGearRatios != B.ReverseGearRatios, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, ReverseGearRatios));
+		Field(A.ChangeUpRPM != B.ChangeUpRPM, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, ChangeUpRPM));
+		Field(A.ChangeDownRPM != B.ChangeDownRPM, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, ChangeDownRPM));
+		Field(A.GearChangeTime != B.GearChangeTime, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, GearChangeTime));
+		Field(A.TransmissionEfficiency != B.TransmissionEfficiency, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, TransmissionEfficiency));
+
+		// gear by gear, what the wheels see is the gear ratio times the final drive. Only the gears which changed
+		if (A.ForwardGearRatios != B.ForwardGearRatios && !Comparer.IsStructFieldFilteredOut(Context, Struct, GET_MEMBER_NAME_CHECKED(FVehicleTransmissionConfig, ForwardGearRatios)))
+		{
+			const int32 NumGears = FMath::Max(A.ForwardGearRatios.Num(), B.ForwardGearRatios.Num());
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FEnumProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	UEnum* EnumDef = Property->GetEnum();
-	FNumericProperty* UnderlyingProperty = Property->GetUnderlyingProperty();
-	check(UnderlyingProperty);
-	int32 IntValueA = UnderlyingProperty->GetSignedIntPropertyValue(PropertyAddrA);
-	int32 IntValueB = UnderlyingProperty->GetSignedIntPropertyValue(PropertyAddrB);
+			for (int32 Gear = 0; Gear < NumGears; ++Gear)
+			{
+				const bool bHasA = A.ForwardGearRatios.IsValidIndex(Gear);
+				const bool bHasB = B.ForwardGearRatios.IsValidIndex(Gear);
+				const FString GearName = PathAEx + ": gear " + FString::FromInt(Gear + 1);
 
-	if (IntValueA != IntValueB)
-	{
-		FString StringValueA = EnumDef->GetAuthoredNameStringByValue(IntValueA);
-		FString StringValueB = EnumDef->GetAuthoredNameStringByValue(IntValueB);
+				if (!bHasA || !bHasB)
+				{
+					Comparer.AddMessage(Context, GearName + (bHasA ? " removed" : " added") + ", ratio " + FString::SanitizeFloat(bHasA ? A.ForwardGearRatios[Gear] : B.ForwardGearRatios[Gear]), EDifferenceType::Info);
+					continue;
+				}
 
-		// for "Engine.Windows Target Settings.Default RHI", GetAuthoredNameStringByValue() returns "DefaultGraphicsRHI_DX12" which
-		// is derived from the enum, but the UI displays "DirectX 12" from the 
-		// metadata of the enum, declared like so:
-		//UENUM()
-		//enum class EDefaultGraphicsRHI : uint8
-		//{
-		//	DefaultGraphicsRHI_Default = 0 UMETA(DisplayName = "Default"),
-		//	DefaultGraphicsRHI_DX11 = 1 UMETA(DisplayName = "DirectX 11"),
-		//	DefaultGraphicsRHI_DX12 = 2 UMETA(DisplayName = "DirectX 12"),
-		// 
+				const float RatioA = A.ForwardGearRatios[Gear];
+				const float RatioB = B.ForwardGearRatios[Gear];
 
-		FText DisplayNameA = EnumDef->GetDisplayNameTextByIndex(IntValueA);
-		FText DisplayNameB = EnumDef->GetDisplayNameTextByIndex(IntValueB);
+				if (RatioA == RatioB)
+				{
+					continue;
+				}
 
-		if (!DisplayNameA.IsEmpty() && DisplayNameA.ToString() != StringValueA)
-		{
-			StringValueA = DisplayNameA.ToString() + "(" + StringValueA + ")";
-		}
-		if (!DisplayNameB.IsEmpty() && DisplayNameB.ToString() != StringValueB)
-		{
-			StringValueB = DisplayNameB.ToString() + "(" + StringValueB + ")";
+				Comparer.AddMessage(Context, GearName + " ratio " + FormatChange(RatioA, RatioB) + ", overall " + FormatChange(RatioA * A.FinalRatio, RatioB * B.FinalRatio), EDifferenceType::Info);
+			}
 		}
-
-		Report(PathA, PathB, "Enum", Property, StringValueA, StringValueB);
 	}
-}
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FBoolProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	const bool ValueA = Property->GetPropertyValue(PropertyAddrA);
-	const bool ValueB = Property->GetPropertyValue(PropertyAddrB);
-	if (ValueA != ValueB)
+	void CompareDifferentialConfig(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* StructAddrA, const uint8* StructAddrB)
 	{
-		FString StringValueA = ValueA ? TEXT("true") : TEXT("false");
-		FString StringValueB = ValueB ? TEXT("true") : TEXT("false");
+		const FVehicleDifferentialConfig& A = *reinterpret_cast<const FVehicleDifferentialConfig*>(StructAddrA);
+		const FVehicleDifferentialConfig& B = *reinterpret_cast<const FVehicleDifferentialConfig*>(StructAddrB);
+		const UScriptStruct* Struct = FVehicleDifferentialConfig::StaticStruct();
 
-		Report(PathA, PathB, "Bool", Property, StringValueA, StringValueB);
-	}
-}
-
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FNumericProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	// see if it's an enum
-	UEnum* EnumDef = Property->GetIntPropertyEnum();
-	if (EnumDef)
-	{
-		// export enums as strings
-		int32 IntValueA = Property->GetSignedIntPropertyValue(PropertyAddrA);
-		int32 IntValueB = Property->GetSignedIntPropertyValue(PropertyAddrB);
+		const FString PathAEx = PathA + "/" + Struct->GetName();
+		const FString PathBEx = PathB + "/" + Struct->GetName();
 
-		if (IntValueA != IntValueB)
+		if (A.DifferentialType != B.DifferentialType)
 		{
-			FString StringValueA = EnumDef->GetAuthoredNameStringByValue(IntValueA);
-			FString StringValueB = EnumDef->GetAuthoredNameStringByValue(IntValueB);
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FVehicleDifferentialConfig, DifferentialType), StructAddrA, StructAddrB);
+		}
 
-			FText DisplayNameA = EnumDef->GetDisplayNameTextByIndex(IntValueA);
-			FText DisplayNameB = EnumDef->GetDisplayNameTextByIndex(IntValueB);
+		if (A.FrontRearSplit != B.FrontRearSplit)
+		{
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FVehicleDifferentialConfig, FrontRearSplit), StructAddrA, StructAddrB);
 
-			if (!DisplayNameA.IsEmpty() && DisplayNameA.ToString() != StringValueA)
-			{
-				StringValueA = DisplayNameA.ToString() + "(" + StringValueA + ")";
-			}
-			if (!DisplayNameB.IsEmpty() && DisplayNameB.ToString() != StringValueB)
+			// below 0.5 sends more torque to the front, only used by all wheel drive
+			if (!Comparer.IsStructFieldFilteredOut(Context, Struct, GET_MEMBER_NAME_CHECKED(FVehicleDifferentialConfig, FrontRearSplit)))
 			{
-				StringValueB = DisplayNameB.ToString() + "(" + StringValueB + ")";
+				const FString Direction = B.FrontRearSplit > A.FrontRearSplit ? "towards the rear" : "towards the front";
+				Comparer.AddMessage(Context, PathAEx + ": torque split moves " + Direction + ", " + FormatChange(A.FrontRearSplit, B.FrontRearSplit), EDifferenceType::Info);
 			}
-
-			Report(PathA, PathB, "Numeric/Enum", Property, StringValueA, StringValueB);
 		}
 	}
-	else if (Property->IsFloatingPoint())
+
+	void CompareSteeringConfig(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* StructAddrA, const uint8* StructAddrB)
 	{
-		const FString StringValueA = FString::SanitizeFloat(Property->GetFloatingPointPropertyValue(PropertyAddrA));
-		const FString StringValueB = FString::SanitizeFloat(Property->GetFloatingPointPropertyValue(PropertyAddrB));
-		if (StringValueA != StringValueB)
+		const FVehicleSteeringConfig& A = *reinterpret_cast<const FVehicleSteeringConfig*>(StructAddrA);
+		const FVehicleSteeringConfig& B = *reinterpret_cast<const FVehicleSteeringConfig*>(StructAddrB);
+		const UScriptStruct* Struct = FVehicleSteeringConfig::StaticStruct();
+
+		const FString PathAEx = PathA + "/" + Struct->GetName();
+		const FString PathBEx = PathB + "/" + Struct->GetName();
+
+		if (A.SteeringType != B.SteeringType)
 		{
-			Report(PathA, PathB, "Numeric/float", Property, StringValueA, StringValueB);
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FVehicleSteeringConfig, SteeringType), StructAddrA, StructAddrB);
 		}
-	}
-	else if (Property->IsInteger())
-	{
-		const FString StringValueA = FString::FromInt(Property->GetSignedIntPropertyValue(PropertyAddrA));
-		const FString StringValueB = FString::FromInt(Property->GetSignedIntPropertyValue(PropertyAddrB));
-		if (StringValueA != StringValueB)
+
+		if (A.AngleRatio != B.AngleRatio)
 		{
-			Report(PathA, PathB, "Numeric/int", Property, StringValueA, StringValueB);
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FVehicleSteeringConfig, AngleRatio), StructAddrA, StructAddrB);
 		}
-	}
-	else
-	{
-		AddError( "No comparison done for Numeric/Unknown property " + Property->GetName() );
-	}
-}
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FStrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	const FString StringValueA = Property->GetPropertyValue(PropertyAddrA);
-	const FString StringValueB = Property->GetPropertyValue(PropertyAddrB);
-	if (StringValueA != StringValueB)
-	{
-		Report(PathA, PathB, "String", Property, Quote + StringValueA + Quote, Quote + StringValueB + Quote);
+		// the curve compares itself, identical curves return straight away
+		Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FVehicleSteeringConfig, SteeringCurve), StructAddrA, StructAddrB);
 	}
-}
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FClassProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	auto A = Property->GetPropertyValue(PropertyAddrA);
-	auto B = Property->GetPropertyValue(PropertyAddrB);
-	const FString StringValueA = A ? A->GetName() : "NULL";
-	const FString StringValueB = B ? B->GetName() : "NULL";
-	if (StringValueA != StringValueB)
+	void CompareWheelSetup(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* StructAddrA, const uint8* StructAddrB)
 	{
-		Report(PathA, PathB, "Class", Property, StringValueA, StringValueB);
-	}
-}
+		const FChaosWheelSetup& A = *reinterpret_cast<const FChaosWheelSetup*>(StructAddrA);
+		const FChaosWheelSetup& B = *reinterpret_cast<const FChaosWheelSetup*>(StructAddrB);
+		const UScriptStruct* Struct = FChaosWheelSetup::StaticStruct();
 
+		const FString PathAEx = PathA + "/" + Struct->GetName();
+		const FString PathBEx = PathB + "/" + Struct->GetName();
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FTextProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	const FString StringValueA = Property->GetPropertyValue(PropertyAddrA).ToString();
-	const FString StringValueB = Property->GetPropertyValue(PropertyAddrB).ToString();
-	if (StringValueA != StringValueB)
-	{
-		Report(PathA, PathB, "Text", Property, Quote + StringValueA + Quote, Quote + StringValueB + Quote);
-	}
-}
+		if (A.WheelClass != B.WheelClass)
+		{
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FChaosWheelSetup, WheelClass), StructAddrA, StructAddrB);
+		}
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FNameProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
-{
-	const FString StringValueA = Property->GetPropertyValue(PropertyAddrA).ToString();
-	const FString StringValueB = Property->GetPropertyValue(PropertyAddrB).ToString();
-	if (StringValueA != StringValueB)
-	{
-		Report(PathA, PathB, "Name", Property, Quote + StringValueA + Quote, Quote + StringValueB + Quote);
+		if (A.BoneName != B.BoneName)
+		{
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FChaosWheelSetup, BoneName), StructAddrA, StructAddrB);
+		}
+
+		if (A.AdditionalOffset != B.AdditionalOffset)
+		{
+			Comparer.CompareStructField(Context, PathAEx, PathBEx, Struct, GET_MEMBER_NAME_CHECKED(FChaosWheelSetup, AdditionalOffset), StructAddrA, StructAddrB);
+		}
 	}
 }
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FObjectPtrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+UVehicleCompareImpl::UVehicleCompareImpl()
 {
-	auto A = Property->GetPropertyValue(PropertyAddrA);
-	auto B = Property->GetPropertyValue(PropertyAddrB);
-	const FString StringValueA = A ? A->GetName() : "NULL";
-	const FString StringValueB = B ? B->GetName() : "NULL";
-	if (StringValueA != StringValueB)
-	{
-		Report(PathA, PathB, "Object", Property, StringValueA, StringValueB);
-	}
+	// the Chaos vehicle setup, most of what is compared on a vehicle
+	PropertyComparer.RegisterStructComparer(FVehicleEngineConfig::StaticStruct(), &CompareEngineConfig);
+	PropertyComparer.RegisterStructComparer(FVehicleTransmissionConfig::StaticStruct(), &CompareTransmissionConfig);
+	PropertyComparer.RegisterStructComparer(FVehicleDifferentialConfig::StaticStruct(), &CompareDifferentialConfig);
+	PropertyComparer.RegisterStructComparer(FVehicleSteeringConfig::StaticStruct(), &CompareSteeringConfig);
+	PropertyComparer.RegisterStructComparer(FChaosWheelSetup::StaticStruct(), &CompareWheelSetup);
 }
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FSoftObjectProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+void UVehicleCompareImpl::CompareComponentProperties(const FString& PathA, const FString& PathB, UClass* Class, const UObject* A, const UObject* B)
 {
-	FSoftObjectPtr A = Property->GetPropertyValue(PropertyAddrA);
-	FSoftObjectPtr B = Property->GetPropertyValue(PropertyAddrB);
-	const FString StringValueA = A.ToString();
-	const FString StringValueB = B.ToString();
-	if (StringValueA != StringValueB)
-	{
-		Report(PathA, PathB, "SoftObject", Property, StringValueA, StringValueB);
-	}
+	// differences found here can be copied between vehicles, they remember which template they are on
+	FDifferenceArraySink Sink(Results);
+	NumPropertiesCompared += PropertyComparer.CompareObjects(PathA, PathB, Class, A, B, Sink, A->GetFName());
+	NumPropertiesTotal += PropertyComparer.GetClassLayout(Class).EditProperties.Num();
 }
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FStructProperty* StructProperty, const uint8* StructAddrA, const uint8* StructAddrB)
+
+void UVehicleCompareImpl::CompareVehicleMovementComponents(
+	const FString& PathA,
+	const FString& PathB,
+	const UChaosWheeledVehicleMovementComponent* A,
+	const UChaosWheeledVehicleMovementComponent* B)
 {
-	if (!StructProperty) return;
+	if (!A) return;
+	if (!B) return;
 
-	UScriptStruct* Struct = StructProperty->Struct;
+	AddInfo("Comparing vehicle movement componnets " + PathA + " with " + PathB);
 
-	if (Struct)
-	{
-		const FString PathAEx = PathA + "/" + Struct->GetName();
-		const FString PathBEx = PathB + "/" + Struct->GetName();
+	CompareComponentProperties(PathA, PathB, UChaosWheeledVehicleMovementComponent::StaticClass(), A, B);
+}
 
-		for (FProperty* Prop = Struct->PropertyLink; Prop != nullptr; Prop = Prop->PropertyLinkNext)
-		{
-			const uint8* PropertyAddrA = Prop->ContainerPtrToValuePtr<uint8>(StructAddrA, 0);
-			const uint8* PropertyAddrB = Prop->ContainerPtrToValuePtr<uint8>(StructAddrB, 0);
 
-			CompareProperty(PathAEx, PathBEx, Prop, PropertyAddrA, PropertyAddrB);
-		}
+bool UVehicleCompareImpl::LoadVehicleComponents(const FString& VehicleAssetPath, FVehicleComponents& OutComponents)
+{
+	UBlueprint* Blueprint = Cast<UBlueprint>(UEditorAssetLibrary::LoadAsset(VehicleAssetPath));
+	if (!Blueprint)
+	{
+		AddError( "Cannot load blueprint \"" + VehicleAssetPath + "\"");
+		return false;
 	}
-}
 
+	OutComponents.AssetPath = VehicleAssetPath;
+	OutComponents.GatherComponents(Blueprint);
 
-void UVehicleCompareImpl::Compare(const FString& PathA, const FString& PathB, FArrayProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+	return true;
+}
+
+void FVehicleComponents::GatherComponents(UBlueprint* InBlueprint)
 {
-	FScriptArrayHelper ArrayHelperA(Property, PropertyAddrA);
-	FScriptArrayHelper ArrayHelperB(Property, PropertyAddrB);
+	Blueprint = InBlueprint;
 
-	if (ArrayHelperA.Num() != ArrayHelperB.Num())
-	{
-		const FString PathAEx = AppendDisplayName(PathA, Property);
-		const FString PathBEx = AppendDisplayName(PathB, Property);
+	Subobjects.Reset();
+	SubobjectNames.Reset();
+	ParentNames.Reset();
+	SkeletalMeshComponents.Reset();
+	VehicleMovementComponents.Reset();
 
-		FString Message = PathAEx + " has " + FString::FromInt(ArrayHelperA.Num()) + " elements, " + PathBEx + " has " + FString::FromInt( ArrayHelperB.Num() );
-		AddWarning(Message);
+	UBlueprintGeneratedClass* GeneratedClass = Blueprint ? Cast<UBlueprintGeneratedClass>(Blueprint->GeneratedClass) : nullptr;
+	if (!GeneratedClass)
+	{
+		return;
 	}
 
-	// this is the array type 
-	if (Property->Inner)
+	// components made by the C++ constructors, the values this blueprint gives them are on its class default object
+	TArray<UObject*> DefaultSubobjects;
+	GeneratedClass->GetDefaultObject()->GetDefaultSubobjects(DefaultSubobjects);
+
+	for (const UObject* Object : DefaultSubobjects)
 	{
-		// need to test all the things it might be an array of 
-		if (FStructProperty* StructProperty = CastField<FStructProperty>(Property->Inner))
+		if (const UActorComponent* Component = Cast<UActorComponent>(Object))
 		{
-			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
-
-			for (int32 i = 0; i < MinI; ++i)
-			{
-				const uint8* StructAddressA = ArrayHelperA.GetRawPtr(i);
-				const uint8* StructAddressB = ArrayHelperB.GetRawPtr(i);
-				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
-				const FString PathAEx = PathA + Suffix;
-				const FString PathBEx = PathB + Suffix;
+			const USceneComponent* SceneComponent = Cast<USceneComponent>(Component);
+			const USceneComponent* AttachParent = SceneComponent ? SceneComponent->GetAttachParent() : nullptr;
 
-				Compare(PathAEx, PathBEx, StructProperty, StructAddressA, StructAddressB);
-			}
+			AddSubobject(Component, Component->GetFName(), AttachParent ? AttachParent->GetFName() : NAME_None);
 		}
-		else if (FNumericProperty* NumericProperty = CastField<FNumericProperty>(Property->Inner))
-		{
-			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+	}
 
-			for (int32 i = 0; i < MinI; ++i)
-			{
-				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
-				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
-				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
-				const FString PathAEx = PathA + Suffix;
-				const FString PathBEx = PathB + Suffix;
+	// components added by the blueprint and its blueprint parents, oldest parent first
+	TArray<const UBlueprintGeneratedClass*> Hierarchy;
+	UBlueprintGeneratedClass::GetGeneratedClassesHierarchy(GeneratedClass, Hierarchy);
 
-				Compare(PathAEx, PathBEx, NumericProperty, DataAddressA, DataAddressB);
-			}
-		}
-		else if (FNameProperty* NameProperty = CastField<FNameProperty>(Property->Inner))
+	for (int32 i = Hierarchy.Num() - 1; i >= 0; --i)
+	{
+		if (const USimpleConstructionScript* SCS = Hierarchy[i]->SimpleConstructionScript)
 		{
-			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
-
-			for (int32 i = 0; i < MinI; ++i)
+			for (const USCS_Node* Node : SCS->GetRootNodes())
 			{
-				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
-				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
-				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
-				const FString PathAEx = PathA + Suffix;
-				const FString PathBEx = PathB + Suffix;
-
-				Compare(PathAEx, PathBEx, NameProperty, DataAddressA, DataAddressB);
+				// a root node can be attached to a component from a parent class
+				AddConstructionNode(Node, Node->ParentComponentOrVariableName, GeneratedClass);
 			}
 		}
-		else if (FObjectPtrProperty* ObjectProperty = CastField<FObjectPtrProperty>(Property->Inner))
-		{
-			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+	}
+}
 
-			for (int32 i = 0; i < MinI; ++i)
-			{
-				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
-				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
-				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
-				const FString PathAEx = PathA + Suffix;
-				const FString PathBEx = PathB + Suffix;
+void FVehicleComponents::AddConstructionNode(const USCS_Node* Node, FName ParentName, UBlueprintGeneratedClass* GeneratedClass)
+{
+	if (!Node)
+	{
+		return;
+	}
 
-				Compare(PathAEx, PathBEx, ObjectProperty, DataAddressA, DataAddressB);
-			}
-		}
-		else if (FEnumProperty* EnumProperty = CastField<FEnumProperty>(Property->Inner))
-		{
-			const int32 MinI = FGenericPlatformMath::Min(ArrayHelperA.Num(), ArrayHelperB.Num());
+	// for an inherited component this is the override the blueprint keeps in its InheritableComponentHandler, if it has one
+	if (const UActorComponent* Template = Node->GetActualComponentTemplate(GeneratedClass))
+	{
+		AddSubobject(Template, Node->GetVariableName(), ParentName);
+	}
 
-			for (int32 i = 0; i < MinI; ++i)
-			{
-				const uint8* DataAddressA = ArrayHelperA.GetRawPtr(i);
-				const uint8* DataAddressB = ArrayHelperB.GetRawPtr(i);
-				const FString Suffix = "/" + Property->GetName() + "[" + FString::FromInt(i) + "]";
-				const FString PathAEx = PathA + Suffix;
-				const FString PathBEx = PathB + Suffix;
+	for (const USCS_Node* Child : Node->GetChildNodes())
+	{
+		AddConstructionNode(Child, Node->GetVariableName(), GeneratedClass);
+	}
+}
 
-				Compare(PathAEx, PathBEx, EnumProperty, DataAddressA, DataAddressB);
-			}
-		}
-		else
+bool FVehicleComponents::AreComponentsValid() const
+{
+	for (const UObject* Object : Subobjects)
+	{
+		if (!IsValid(Object))
 		{
-			AddError( "No comparison done for " + Property->Inner->GetClass()->GetName() );
+			return false;
 		}
 	}
-}
-
-
 
+	return true;
+}
 
-void UVehicleCompareImpl::CompareVehicleMovementComponents(
-	const FString& PathA,
-	const FString& PathB,
-	const UChaosWheeledVehicleMovementComponent* A,
-	const UChaosWheeledVehicleMovementComponent* B)
+void FVehicleComponents::AddSubobject(const UObject* Object, FName Name, FName ParentName)
 {
-	if (!A) return;
-	if (!B) return;
-
-	AddInfo("Comparing vehicle movement componnets " + PathA + " with " + PathB);
-
-	for (TFieldIterator<FProperty> It(UChaosWheeledVehicleMovementComponent::StaticClass()); It; ++It)
+	if (const UChaosWheeledVehicleMovementComponent* Comp = Cast< const UChaosWheeledVehicleMovementComponent >(Object))
 	{
-		FProperty* Property = *It;
-
-		if (Property->HasAnyPropertyFlags(EPropertyFlags::CPF_Edit))
-		{
-			const uint8* PropertyAddrA = Property->ContainerPtrToValuePtr<uint8>(A);
-			const uint8* PropertyAddrB = Property->ContainerPtrToValuePtr<uint8>(B);
+		VehicleMovementComponents.Add(Comp);
+	}
 
-			CompareProperty(PathA, PathB, Property, PropertyAddrA, PropertyAddrB);
-		}
+	if (const USkeletalMeshComponent* Skel = Cast< const USkeletalMeshComponent >(Object))
+	{
+		SkeletalMeshComponents.Add(Skel);
 	}
+
+	Subobjects.Add(Object);
+	SubobjectNames.Add(Name);
+	ParentNames.Add(ParentName);
 }
 
 
@@ -400,53 +370,47 @@ void UVehicleCompareImpl::CompareVehicleBlueprints(const FString& VehicleAssetPa
 
 	TArray< FString > Paths = { VehicleAssetPath1, VehicleAssetPath2 };
 
-	TArray< UBlueprint* > Blueprints;
+	TArray< FVehicleComponents > Vehicles = { {}, {} };
 
 	for (int i = 0; i < Paths.Num(); ++i)
 	{
-		UBlueprint* Blueprint = Cast<UBlueprint>(UEditorAssetLibrary::LoadAsset(Paths[i]));
-		if (!Blueprint)
+		if (!LoadVehicleComponents(Paths[i], Vehicles[i]))
 		{
-			AddError( "Cannot load blueprint \"" + Paths[i] + "\"");
 			return;
 		}
-		else
-		{
-			Blueprints.Add(Blueprint);
-		}
 	}
 
-	USubobjectDataSubsystem* SubobjectDataSubsystem = USubobjectDataSubsystem::Get();
+	CompareLoadedVehicles(Vehicles[0], Vehicles[1]);
+}
 
-	TArray< TArray< FSubobjectDataHandle > > SubobjectDataHandles = { {}, {} };
-	TArray< TArray< FSubobjectData > > SubobjectDatas = { {}, {} };
-	TArray< TArray< const UObject* > > Subobjects = { {}, {} };
-	TArray< TArray< const USkeletalMeshComponent* > > SkeletalMeshComponents = { {}, {} };
-	TArray< TArray< const UChaosWheeledVehicleMovementComponent* > > VehicleMovementComponents = { {}, {} };
+void UVehicleCompareImpl::CompareVehicleComponents(const FVehicleComponents& Vehicle1, const FVehicleComponents& Vehicle2)
+{
+	AddInfo("Comparing " + Vehicle1.AssetPath + " with " + Vehicle2.AssetPath);
 
-	for (int i = 0; i < Blueprints.Num(); ++i)
-	{
-		SubobjectDataSubsystem->K2_GatherSubobjectDataForBlueprint(Blueprints[i], SubobjectDataHandles[i]);
-		for (const FSubobjectDataHandle& Handle : SubobjectDataHandles[i])
-		{
-			FSubobjectData Data;
-			SubobjectDataSubsystem->K2_FindSubobjectDataFromHandle(Handle, Data);
-			SubobjectDatas[i].Add(Data);
+	CompareLoadedVehicles(Vehicle1, Vehicle2);
+}
 
-			const UObject* Object = USubobjectDataBlueprintFunctionLibrary::GetObject(Data);
-			if (const UChaosWheeledVehicleMovementComponent* Comp = Cast< const UChaosWheeledVehicleMovementComponent >(Object))
-			{
-				VehicleMovementComponents[i].Add(Comp);
-			}
+void UVehicleCompareImpl::CompareLoadedVehicles(const FVehicleComponents& Vehicle1, const FVehicleComponents& Vehicle2)
+{
+	// the caller's vehicles, not copies
+	const FVehicleComponents* const Vehicles[] = { &Vehicle1, &Vehicle2 };
 
-			if (const USkeletalMeshComponent* Skel = Cast< const USkeletalMeshComponent >(Object))
-			{
-				SkeletalMeshComponents[i].Add(Skel);
-			}
+	// the vehicles are loaded already, from here on everything allocated is ours
+	LLM_SCOPE_BYTAG(CompareVehicleBlueprints);
 
-			Subobjects[i].Add(Object);
-		}
-	}
+	PropertyComparer.ApplySettings(*GetDefault<UCompareVehicleBlueprintsSettings>());
+
+	NumPropertiesCompared = 0;
+	NumPropertiesTotal = 0;
+
+	const FString& VehicleAssetPath1 = Vehicles[0]->AssetPath;
+	const FString& VehicleAssetPath2 = Vehicles[1]->AssetPath;
+	TArray< FString > Paths = { VehicleAssetPath1, VehicleAssetPath2 };
+
+	// views, the component lists stay where the vehicles keep them
+	TArray< TConstArrayView< const UObject* > > Subobjects = { Vehicles[0]->Subobjects, Vehicles[1]->Subobjects };
+	TArray< TConstArrayView< const USkeletalMeshComponent* > > SkeletalMeshComponents = { Vehicles[0]->SkeletalMeshComponents, Vehicles[1]->SkeletalMeshComponents };
+	TArray< TConstArrayView< const UChaosWheeledVehicleMovementComponent* > > VehicleMovementComponents = { Vehicles[0]->VehicleMovementComponents, Vehicles[1]->VehicleMovementComponents };
 
 	bool PrintComponentList = false;
 
@@ -470,13 +434,14 @@ void UVehicleCompareImpl::CompareVehicleBlueprints(const FString& VehicleAssetPa
 
 	if (PrintComponentList)
 	{
-		for (int i = 0; i < Blueprints.Num(); ++i)
+		for (int i = 0; i < int(UE_ARRAY_COUNT(Vehicles)); ++i)
 		{
-			AddWarning("Blueprint subobjects for " + Blueprints[i]->GetFName().ToString());
+			AddWarning("Blueprint subobjects for " + Vehicles[i]->Blueprint->GetFName().ToString());
 
-			for (const UObject* Object : Subobjects[i])
+			for (int j = 0; j < Subobjects[i].Num(); ++j)
 			{
-				AddWarning("   subobject " + Object->GetFName().ToString());
+				const FName ParentName = Vehicles[i]->ParentNames[j];
+				AddWarning("   subobject " + Vehicles[i]->SubobjectNames[j].ToString() + (ParentName.IsNone() ? FString() : " attached to " + ParentName.ToString()));
 			}
 		}
 	}
@@ -513,6 +478,12 @@ void UVehicleCompareImpl::CompareVehicleBlueprints(const FString& VehicleAssetPa
 		const FString NameA = SkeletalMeshComponents[0][i]->GetName();
 		const FString NameB = SkeletalMeshComponents[1][i]->GetName();
 		CompareSkeletalMeshComponents(PathA + "/" + NameA, PathB + "/" + NameB, SkeletalMeshComponents[0][i], SkeletalMeshComponents[1][i]);
+
+		// the physics asset decides a lot about how the car handles but is only referenced by the component
+		ComparePhysicsAssets(PathA + "/" + NameA + "/PhysicsAsset", PathB + "/" + NameB + "/PhysicsAsset", SkeletalMeshComponents[0][i]->GetPhysicsAsset(), SkeletalMeshComponents[1][i]->GetPhysicsAsset());
+
+		// bone hierarchy, for when a mesh has been moved onto a new skeleton
+		CompareSkeletons(PathA + "/" + NameA + "/Skeleton", PathB + "/" + NameB + "/Skeleton", SkeletalMeshComponents[0][i]->GetSkeletalMeshAsset(), SkeletalMeshComponents[1][i]->GetSkeletalMeshAsset());
 	}
 
 	// compare wheel bone names with bones names in skeleton
@@ -526,6 +497,19 @@ void UVehicleCompareImpl::CompareVehicleBlueprints(const FString& VehicleAssetPa
 		}
 	}
 
+	// vehicle logic in the event graphs and functions
+	if (GetDefault<UCompareVehicleBlueprintsSettings>()->bCompareGraphs)
+	{
+		FBlueprintGraphComparer GraphComparer;
+		GraphComparer.Compare(PathA + "/Graphs", PathB + "/Graphs", Vehicles[0]->Blueprint, Vehicles[1]->Blueprint);
+		Results.Append(GraphComparer.GetResults());
+	}
+
+	// one line for the whole comparison rather than one per component
+	if (PropertyComparer.GetUseArchetypePrefilter() && NumPropertiesTotal > 0)
+	{
+		AddInfo("Compared " + FString::FromInt(NumPropertiesCompared) + " of " + FString::FromInt(NumPropertiesTotal) + " component properties, the rest are class defaults on both sides");
+	}
 }
 
 
@@ -536,99 +520,456 @@ void UVehicleCompareImpl::CompareSkeletalMeshComponents(const FString& PathA, co
 
 	AddInfo("Comparing skeletal mesh components " + PathA + " with " + PathB);
 
-	for (TFieldIterator<FProperty> It(USkeletalMeshComponent::StaticClass()); It; ++It)
-	{
-		FProperty* Property = *It;
-
-		if (Property->HasAnyPropertyFlags(EPropertyFlags::CPF_Edit))
-		{
-			const uint8* PropertyAddrA = Property->ContainerPtrToValuePtr<uint8>(A);
-			const uint8* PropertyAddrB = Property->ContainerPtrToValuePtr<uint8>(B);
-
-			CompareProperty(PathA, PathB, Property, PropertyAddrA, PropertyAddrB);
-		}
-	}
+	CompareComponentProperties(PathA, PathB, USkeletalMeshComponent::StaticClass(), A, B);
 }
 
 
-const TArray<TSharedRef<FDifference>> & UVehicleCompareImpl::GetResults() const
-{
-	return Results;
-}
-
-void UVehicleCompareImpl::AddMessage(const FString& Message, const EDifferenceType& Type)
+void UVehicleCompareImpl::ReportValues(const FString& PathA, const FString& PathB, const FString& StringValueA, const FString& StringValueB)
 {
 	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
-	Diff->Type = Type;
-	Diff->Message = Message;
+	Diff->Type = EDifferenceType::Difference;
+	Diff->Paths.Add(PathA);
+	Diff->Paths.Add(PathB);
+	Diff->ValuesAsString.Add(StringValueA);
+	Diff->ValuesAsString.Add(StringValueB);
 	Results.Add(Diff);
 }
 
-void UVehicleCompareImpl::AddWarning(const FString& Message)
+void UVehicleCompareImpl::CompareObjectProperties(const FString& PathA, const FString& PathB, UClass* Class, const UObject* A, const UObject* B, const FName SkipProperty)
 {
-	AddMessage(Message, EDifferenceType::Warning);
+	FDifferenceArraySink Sink(Results);
+	PropertyComparer.CompareObjects(PathA, PathB, Class, A, B, Sink, NAME_None, SkipProperty);
 }
 
-void UVehicleCompareImpl::AddError(const FString& Message)
+void UVehicleCompareImpl::CompareBodyGeometry(const FString& PathA, const FString& PathB, const FKAggregateGeom& A, const FKAggregateGeom& B)
 {
-	AddMessage(Message, EDifferenceType::Error);
+	// shapes of each kind are matched by index and compared with a tolerance
+	auto CompareShapes = [&](const FString& Kind, const auto& ElemsA, const auto& ElemsB, auto IsEqual, auto Describe)
+	{
+		if (ElemsA.Num() != ElemsB.Num())
+		{
+			AddWarning(PathA + " has " + FString::FromInt(ElemsA.Num()) + " " + Kind + " shapes, " + PathB + " has " + FString::FromInt(ElemsB.Num()));
+		}
+
+		const int32 MinI = FGenericPlatformMath::Min(ElemsA.Num(), ElemsB.Num());
+
+		for (int32 i = 0; i < MinI; ++i)
+		{
+			if (!IsEqual(ElemsA[i], ElemsB[i]))
+			{
+				const FString Suffix = "/" + Kind + "[" + FString::FromInt(i) + "]";
+				ReportValues(PathA + Suffix, PathB + Suffix, Describe(ElemsA[i]), Describe(ElemsB[i]));
+			}
+		}
+	};
+
+	auto NearlyEqual = [](float X, float Y) { return FMath::IsNearlyEqual(X, Y, GeometryTolerance); };
+
+	CompareShapes("Sphere", A.SphereElems, B.SphereElems,
+		[&](const FKSphereElem& X, const FKSphereElem& Y)
+		{
+			return X.Center.Equals(Y.Center, GeometryTolerance) && NearlyEqual(X.Radius, Y.Radius);
+		},
+		[](const FKSphereElem& X)
+		{
+			return "Center " + X.Center.ToString() + " Radius " + FString::SanitizeFloat(X.Radius);
+		});
+
+	CompareShapes("Box", A.BoxElems, B.BoxElems,
+		[&](const FKBoxElem& X, const FKBoxElem& Y)
+		{
+			return X.Center.Equals(Y.Center, GeometryTolerance) && X.Rotation.Equals(Y.Rotation, GeometryTolerance)
+				&& NearlyEqual(X.X, Y.X) && NearlyEqual(X.Y, Y.Y) && NearlyEqual(X.Z, Y.Z);
+		},
+		[](const FKBoxElem& X)
+		{
+			return "Center " + X.Center.ToString() + " Rotation " + X.Rotation.ToString()
+				+ " Size " + FString::SanitizeFloat(X.X) + " " + FString::SanitizeFloat(X.Y) + " " + FString::SanitizeFloat(X.Z);
+		});
+
+	CompareShapes("Capsule", A.SphylElems, B.SphylElems,
+		[&](const FKSphylElem& X, const FKSphylElem& Y)
+		{
+			return X.Center.Equals(Y.Center, GeometryTolerance) && X.Rotation.Equals(Y.Rotation, GeometryTolerance)
+				&& NearlyEqual(X.Radius, Y.Radius) && NearlyEqual(X.Length, Y.Length);
+		},
+		[](const FKSphylElem& X)
+		{
+			return "Center " + X.Center.ToString() + " Rotation " + X.Rotation.ToString()
+				+ " Radius " + FString::SanitizeFloat(X.Radius) + " Length " + FString::SanitizeFloat(X.Length);
+		});
+
+	CompareShapes("TaperedCapsule", A.TaperedCapsuleElems, B.TaperedCapsuleElems,
+		[&](const FKTaperedCapsuleElem& X, const FKTaperedCapsuleElem& Y)
+		{
+			return X.Center.Equals(Y.Center, GeometryTolerance) && X.Rotation.Equals(Y.Rotation, GeometryTolerance)
+				&& NearlyEqual(X.Radius0, Y.Radius0) && NearlyEqual(X.Radius1, Y.Radius1) && NearlyEqual(X.Length, Y.Length);
+		},
+		[](const FKTaperedCapsuleElem& X)
+		{
+			return "Center " + X.Center.ToString() + " Rotation " + X.Rotation.ToString()
+				+ " Radii " + FString::SanitizeFloat(X.Radius0) + " " + FString::SanitizeFloat(X.Radius1) + " Length " + FString::SanitizeFloat(X.Length);
+		});
+
+	CompareShapes("Convex", A.ConvexElems, B.ConvexElems,
+		[&](const FKConvexElem& X, const FKConvexElem& Y)
+		{
+			if (X.VertexData.Num() != Y.VertexData.Num() || !X.GetTransform().Equals(Y.GetTransform(), GeometryTolerance))
+			{
+				return false;
+			}
+
+			for (int32 v = 0; v < X.VertexData.Num(); ++v)
+			{
+				if (!X.VertexData[v].Equals(Y.VertexData[v], GeometryTolerance))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		},
+		[](const FKConvexElem& X)
+		{
+			return FString::FromInt(X.VertexData.Num()) + " vertices, bounds " + X.ElemBox.ToString();
+		});
 }
 
-void UVehicleCompareImpl::AddInfo(const FString& Message)
+void UVehicleCompareImpl::ComparePhysicsAssets(const FString& PathA, const FString& PathB, const UPhysicsAsset* A, const UPhysicsAsset* B)
 {
-	AddMessage(Message, EDifferenceType::Info );
+	if (!A) return;
+	if (!B) return;
+
+	if (A == B)
+	{
+		return;
+	}
+
+	AddInfo("Comparing physics assets " + A->GetPathName() + " with " + B->GetPathName());
+
+	// bodies are joined on bone name, so the order they were created in does not matter
+	TMap<FName, const USkeletalBodySetup*> BodiesB;
+	BodiesB.Reserve(B->SkeletalBodySetups.Num());
+
+	for (const USkeletalBodySetup* Body : B->SkeletalBodySetups)
+	{
+		if (Body)
+		{
+			BodiesB.Add(Body->BoneName, Body);
+		}
+	}
+
+	TSet<FName> MatchedBones;
+	MatchedBones.Reserve(A->SkeletalBodySetups.Num());
+
+	for (const USkeletalBodySetup* BodyA : A->SkeletalBodySetups)
+	{
+		if (!BodyA)
+		{
+			continue;
+		}
+
+		const FString BoneName = BodyA->BoneName.ToString();
+		const USkeletalBodySetup* const* BodyB = BodiesB.Find(BodyA->BoneName);
+
+		if (!BodyB)
+		{
+			AddWarning(PathA + " has a body for bone \"" + BoneName + "\", " + PathB + " does not");
+			continue;
+		}
+
+		MatchedBones.Add(BodyA->BoneName);
+
+		const FString BodyPathA = PathA + "/Bodies/" + BoneName;
+		const FString BodyPathB = PathB + "/Bodies/" + BoneName;
+
+		CompareBodyGeometry(BodyPathA, BodyPathB, BodyA->AggGeom, (*BodyB)->AggGeom);
+
+		// everything else on the body, including the mass override in DefaultInstance
+		CompareObjectProperties(BodyPathA, BodyPathB, USkeletalBodySetup::StaticClass(), BodyA, *BodyB, GET_MEMBER_NAME_CHECKED(UBodySetup, AggGeom));
+	}
+
+	for (const TPair<FName, const USkeletalBodySetup*>& Pair : BodiesB)
+	{
+		if (!MatchedBones.Contains(Pair.Key))
+		{
+			AddWarning(PathB + " has a body for bone \"" + Pair.Key.ToString() + "\", " + PathA + " does not");
+		}
+	}
+
+	// constraints are joined on joint name
+	TMap<FName, const UPhysicsConstraintTemplate*> ConstraintsB;
+	ConstraintsB.Reserve(B->ConstraintSetup.Num());
+
+	for (const UPhysicsConstraintTemplate* Constraint : B->ConstraintSetup)
+	{
+		if (Constraint)
+		{
+			ConstraintsB.Add(Constraint->DefaultInstance.JointName, Constraint);
+		}
+	}
+
+	TSet<FName> MatchedJoints;
+	MatchedJoints.Reserve(A->ConstraintSetup.Num());
+
+	for (const UPhysicsConstraintTemplate* ConstraintA : A->ConstraintSetup)
+	{
+		if (!ConstraintA)
+		{
+			continue;
+		}
+
+		const FName JointName = ConstraintA->DefaultInstance.JointName;
+		const UPhysicsConstraintTemplate* const* ConstraintB = ConstraintsB.Find(JointName);
+
+		if (!ConstraintB)
+		{
+			AddWarning(PathA + " has a constraint \"" + JointName.ToString() + "\", " + PathB + " does not");
+			continue;
+		}
+
+		MatchedJoints.Add(JointName);
+
+		CompareObjectProperties(PathA + "/Constraints/" + JointName.ToString(), PathB + "/Constraints/" + JointName.ToString(),
+			UPhysicsConstraintTemplate::StaticClass(), ConstraintA, *ConstraintB);
+	}
+
+	for (const TPair<FName, const UPhysicsConstraintTemplate*>& Pair : ConstraintsB)
+	{
+		if (!MatchedJoints.Contains(Pair.Key))
+		{
+			AddWarning(PathB + " has a constraint \"" + Pair.Key.ToString() + "\", " + PathA + " does not");
+		}
+	}
 }
 
-void UVehicleCompareImpl::CompareProperty(const FString& PathA, const FString& PathB, FProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB)
+
+void UVehicleCompareImpl::CompareSkeletons(const FString& PathA, const FString& PathB, const USkeletalMesh* A, const USkeletalMesh* B)
 {
-	// cast to every possible class, thats the way its done in the engine
-	if (FEnumProperty* TypedProperty = CastField<FEnumProperty>(Property))
+	if (!A) return;
+	if (!B) return;
+
+	if (A == B)
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		return;
 	}
-	else if (FBoolProperty* TypedProperty = CastField<FBoolProperty>(Property))
+
+	const FReferenceSkeleton& RefA = A->GetRefSkeleton();
+	const FReferenceSkeleton& RefB = B->GetRefSkeleton();
+
+	AddInfo("Comparing skeletons of " + A->GetPathName() + " (" + FString::FromInt(RefA.GetRawBoneNum()) + " bones) with "
+		+ B->GetPathName() + " (" + FString::FromInt(RefB.GetRawBoneNum()) + " bones)");
+
+	const TArray<FMeshBoneInfo>& BonesA = RefA.GetRawRefBoneInfo();
+	const TArray<FMeshBoneInfo>& BonesB = RefB.GetRawRefBoneInfo();
+	const TArray<FTransform>& PoseA = RefA.GetRawRefBonePose();
+	const TArray<FTransform>& PoseB = RefB.GetRawRefBonePose();
+
+	auto ParentName = [](const TArray<FMeshBoneInfo>& Bones, int32 BoneIndex) -> FString
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		const int32 ParentIndex = Bones[BoneIndex].ParentIndex;
+		return ParentIndex == INDEX_NONE ? FString("(root)") : Bones[ParentIndex].Name.ToString();
+	};
+
+	auto DescribePose = [](const FTransform& Transform) -> FString
+	{
+		return "Location " + Transform.GetLocation().ToString() + " Rotation " + Transform.Rotator().ToString() + " Scale " + Transform.GetScale3D().ToString();
+	};
+
+	// FReferenceSkeleton keeps a name -> index map, so matching every bone is linear in the number of bones
+	for (int32 IndexA = 0; IndexA < BonesA.Num(); ++IndexA)
+	{
+		const FName BoneName = BonesA[IndexA].Name;
+		const int32 IndexB = RefB.FindRawBoneIndex(BoneName);
+
+		if (IndexB == INDEX_NONE)
+		{
+			AddWarning(PathA + " has bone \"" + BoneName.ToString() + "\", " + PathB + " does not");
+			continue;
+		}
+
+		const FString BonePathA = PathA + "/" + BoneName.ToString();
+		const FString BonePathB = PathB + "/" + BoneName.ToString();
+
+		const FString ParentA = ParentName(BonesA, IndexA);
+		const FString ParentB = ParentName(BonesB, IndexB);
+
+		if (ParentA != ParentB)
+		{
+			ReportValues(BonePathA + "/Parent", BonePathB + "/Parent", ParentA, ParentB);
+		}
+
+		if (!PoseA[IndexA].Equals(PoseB[IndexB], GeometryTolerance))
+		{
+			ReportValues(BonePathA + "/RefPose", BonePathB + "/RefPose", DescribePose(PoseA[IndexA]), DescribePose(PoseB[IndexB]));
+		}
 	}
-	else if (FNumericProperty* TypedProperty = CastField<FNumericProperty>(Property))
+
+	for (const FMeshBoneInfo& BoneB : BonesB)
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		if (RefA.FindRawBoneIndex(BoneB.Name) == INDEX_NONE)
+		{
+			AddWarning(PathB + " has bone \"" + BoneB.Name.ToString() + "\", " + PathA + " does not");
+		}
 	}
-	else if (FStrProperty* TypedProperty = CastField<FStrProperty>(Property))
+}
+
+
+void UVehicleCompareImpl::CaptureProperty(const FString& Path, FProperty* Property, const uint8* PropertyAddr, FVehicleSnapshot& Snapshot)
+{
+	if (FStructProperty* StructProperty = CastField<FStructProperty>(Property))
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		for (FProperty* Prop = StructProperty->Struct->PropertyLink; Prop != nullptr; Prop = Prop->PropertyLinkNext)
+		{
+			CaptureProperty(Path + "." + Prop->GetName(), Prop, Prop->ContainerPtrToValuePtr<uint8>(PropertyAddr, 0), Snapshot);
+		}
 	}
-	else if (FTextProperty* TypedProperty = CastField<FTextProperty>(Property))
+	else if (FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		FScriptArrayHelper ArrayHelper(ArrayProperty, PropertyAddr);
+
+		for (int32 i = 0; i < ArrayHelper.Num(); ++i)
+		{
+			CaptureProperty(Path + "[" + FString::FromInt(i) + "]", ArrayProperty->Inner, ArrayHelper.GetRawPtr(i), Snapshot);
+		}
 	}
-	else if (FArrayProperty* TypedProperty = CastField<FArrayProperty>(Property))
+	else
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		// leaf values are stored as the same text the editor uses for copy and paste
+		FString Value;
+		Property->ExportTextItem_Direct(Value, PropertyAddr, nullptr, nullptr, PPF_None);
+		Snapshot.Values.Add(Path, Value);
 	}
-	else if (FStructProperty* TypedProperty = CastField<FStructProperty>(Property))
+}
+
+void UVehicleCompareImpl::CaptureComponent(const FString& Path, UClass* Class, const UObject* Component, FVehicleSnapshot& Snapshot)
+{
+	if (!Component) return;
+
+	LLM_SCOPE_BYTAG(CompareVehicleBlueprints);
+
+	for (FProperty* Property : PropertyComparer.GetClassLayout(Class).EditProperties)
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		const uint8* PropertyAddr = Property->ContainerPtrToValuePtr<uint8>(Component);
+
+		CaptureProperty(Path + "." + Property->GetName(), Property, PropertyAddr, Snapshot);
 	}
-	else if (FClassProperty* TypedProperty = CastField<FClassProperty>(Property))
+}
+
+bool UVehicleCompareImpl::CaptureVehicleSnapshot(const FString& VehicleAssetPath, FVehicleSnapshot& OutSnapshot)
+{
+	FVehicleComponents Vehicle;
+	if (!LoadVehicleComponents(VehicleAssetPath, Vehicle))
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		return false;
 	}
-	else if (FNameProperty* TypedProperty = CastField<FNameProperty>(Property))
+
+	OutSnapshot.VehicleAssetPath = VehicleAssetPath;
+	OutSnapshot.Values.Reset();
+
+	for (const UChaosWheeledVehicleMovementComponent* Component : Vehicle.VehicleMovementComponents)
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		CaptureComponent(Component->GetName(), UChaosWheeledVehicleMovementComponent::StaticClass(), Component, OutSnapshot);
 	}
-	else if (FObjectPtrProperty* TypedProperty = CastField<FObjectPtrProperty>(Property))
+
+	for (const USkeletalMeshComponent* Component : Vehicle.SkeletalMeshComponents)
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		CaptureComponent(Component->GetName(), USkeletalMeshComponent::StaticClass(), Component, OutSnapshot);
 	}
-	else if (FSoftObjectProperty* TypedProperty = CastField<FSoftObjectProperty>(Property))
+
+	return true;
+}
+
+int32 UVehicleCompareImpl::CompareVehicleWithSnapshot(const FString& VehicleAssetPath, const FVehicleSnapshot& Snapshot, const TArray<FString>& AllowList)
+{
+	AddInfo("Comparing " + VehicleAssetPath + " with snapshot of " + Snapshot.VehicleAssetPath);
+
+	FVehicleSnapshot Live;
+	if (!CaptureVehicleSnapshot(VehicleAssetPath, Live))
 	{
-		Compare(PathA, PathB, TypedProperty, PropertyAddrA, PropertyAddrB);
+		return 1;
 	}
-	else {
-		AddError( "No comparison done for property " + Property->GetName()) ;
+
+	LLM_SCOPE_BYTAG(CompareVehicleBlueprints);
+
+	const FString SnapshotLabel = "snapshot";
+	const FString MissingValue = "(missing)";
+
+	int32 NumFailures = 0;
+
+	auto ReportValue = [&](const FString& Path, const FString& GoldenValue, const FString& LiveValue)
+	{
+		for (const FString& Pattern : AllowList)
+		{
+			if (Path.MatchesWildcard(Pattern))
+			{
+				AddInfo("Allowed difference " + Path + " snapshot " + GoldenValue + " live " + LiveValue);
+				return;
+			}
+		}
+
+		TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+		Diff->Type = EDifferenceType::Difference;
+		Diff->Paths.Add(SnapshotLabel + "/" + Path);
+		Diff->Paths.Add(VehicleAssetPath + "/" + Path);
+		Diff->ValuesAsString.Add(GoldenValue);
+		Diff->ValuesAsString.Add(LiveValue);
+		Results.Add(Diff);
+
+		++NumFailures;
+	};
+
+	for (const TPair<FString, FString>& Golden : Snapshot.Values)
+	{
+		const FString* LiveValue = Live.Values.Find(Golden.Key);
+		if (!LiveValue)
+		{
+			ReportValue(Golden.Key, Golden.Value, MissingValue);
+		}
+		else if (*LiveValue != Golden.Value)
+		{
+			ReportValue(Golden.Key, Golden.Value, *LiveValue);
+		}
+	}
+
+	for (const TPair<FString, FString>& Current : Live.Values)
+	{
+		if (!Snapshot.Values.Contains(Current.Key))
+		{
+			ReportValue(Current.Key, MissingValue, Current.Value);
+		}
 	}
+
+	return NumFailures;
+}
+
+
+const TArray<TSharedRef<FDifference>> & UVehicleCompareImpl::GetResults() const
+{
+	return Results;
+}
+
+void UVehicleCompareImpl::AddMessage(const FString& Message, const EDifferenceType& Type)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = Type;
+	Diff->Message = Message;
+	Results.Add(Diff);
+}
+
+void UVehicleCompareImpl::AddWarning(const FString& Message)
+{
+	AddMessage(Message, EDifferenceType::Warning);
+}
+
+void UVehicleCompareImpl::AddError(const FString& Message)
+{
+	AddMessage(Message, EDifferenceType::Error);
+}
+
+void UVehicleCompareImpl::AddInfo(const FString& Message)
+{
+	AddMessage(Message, EDifferenceType::Info );
 }
 
 // check the BP_Car ... BoneNames has wheel names for those names used in the ChaosWheeledVehicleMovementComponent->WheelSetup
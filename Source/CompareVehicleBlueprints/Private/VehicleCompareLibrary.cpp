@@ -0,0 +1,73 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "VehicleCompareLibrary.h"
+#include "VehicleCompareSubsystem.h"
+#include "Editor.h"
+#include "VehicleAssetFilter.h"
+#include "Difference.h"
+
+namespace
+{
+	EVehicleDifferenceType ToScriptType(EDifferenceType Type)
+	{
+		switch (Type)
+		{
+		case EDifferenceType::Info: return EVehicleDifferenceType::Info;
+		case EDifferenceType::Error: return EVehicleDifferenceType::Error;
+		case EDifferenceType::Warning: return EVehicleDifferenceType::Warning;
+		default: return EVehicleDifferenceType::Difference;
+		}
+	}
+}
+
+TArray<FVehicleComparisonResult> UVehicleCompareLibrary::CompareVehicleBlueprintPairs(const TArray<FVehicleBlueprintPair>& Pairs, bool bIncludeInfo)
+{
+	TArray<FVehicleComparisonResult> ComparisonResults;
+	ComparisonResults.Reserve(Pairs.Num());
+
+	// the editor's comparer, class layouts carry over from earlier batches and clicks in the window
+	UVehicleCompareSubsystem* CompareSubsystem = GEditor ? GEditor->GetEditorSubsystem<UVehicleCompareSubsystem>() : nullptr;
+	if (!CompareSubsystem)
+	{
+		return ComparisonResults;
+	}
+
+	for (const FVehicleBlueprintPair& Pair : Pairs)
+	{
+		const TArray<TSharedRef<FDifference>> Differences = CompareSubsystem->CompareVehicleBlueprints(Pair.VehicleA, Pair.VehicleB);
+
+		FVehicleComparisonResult& ComparisonResult = ComparisonResults.AddDefaulted_GetRef();
+		ComparisonResult.Pair = Pair;
+
+		for (const TSharedRef<FDifference>& Diff : Differences)
+		{
+			ComparisonResult.NumDifferences += Diff->Type == EDifferenceType::Difference ? 1 : 0;
+			ComparisonResult.NumErrors += Diff->Type == EDifferenceType::Error ? 1 : 0;
+
+			if (Diff->Type == EDifferenceType::Info && !bIncludeInfo)
+			{
+				continue;
+			}
+
+			FVehicleDifferenceResult& Result = ComparisonResult.Results.AddDefaulted_GetRef();
+			Result.Type = ToScriptType(Diff->Type);
+			Result.Message = Diff->Message;
+
+			if (Diff->Paths.Num() == 2 && Diff->ValuesAsString.Num() == 2)
+			{
+				Result.PathA = Diff->Paths[0];
+				Result.PathB = Diff->Paths[1];
+				Result.ValueA = Diff->ValuesAsString[0];
+				Result.ValueB = Diff->ValuesAsString[1];
+			}
+		}
+	}
+
+	return ComparisonResults;
+}
+
+TArray<FString> UVehicleCompareLibrary::FindWheeledVehicleBlueprints(const TArray<FString>& PackagePaths, const FString& NameFilter)
+{
+	FVehicleAssetFilter VehicleAssetFilter;
+	return VehicleAssetFilter.FindWheeledVehicleBlueprints(PackagePaths, NameFilter);
+}
@@ -0,0 +1,84 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "VehicleCompareSubsystem.h"
+#include "Editor.h"
+#include "UObject/UObjectGlobals.h"
+
+void UVehicleCompareSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Comparer = NewObject<UVehicleCompareImpl>(this);
+
+	// a compile rebuilds the properties of the blueprint's class in place, so its cached layout would be wrong
+	if (GEditor)
+	{
+		BlueprintCompiledHandle = GEditor->OnBlueprintCompiled().AddUObject(this, &UVehicleCompareSubsystem::OnBlueprintCompiled);
+	}
+
+	ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddUObject(this, &UVehicleCompareSubsystem::OnObjectsReinstanced);
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UVehicleCompareSubsystem::OnPostGarbageCollect);
+}
+
+void UVehicleCompareSubsystem::Deinitialize()
+{
+	if (GEditor)
+	{
+		GEditor->OnBlueprintCompiled().Remove(BlueprintCompiledHandle);
+	}
+
+	FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+	Comparer = nullptr;
+
+	Super::Deinitialize();
+}
+
+TArray<TSharedRef<FDifference>> UVehicleCompareSubsystem::CompareVehicleComponents(const FVehicleComponents& Vehicle1, const FVehicleComponents& Vehicle2)
+{
+	Comparer->ResetResults();
+	Comparer->CompareVehicleComponents(Vehicle1, Vehicle2);
+
+	return Comparer->TakeResults();
+}
+
+TArray<TSharedRef<FDifference>> UVehicleCompareSubsystem::CompareVehicleBlueprints(const FString& VehicleAssetPath1, const FString& VehicleAssetPath2)
+{
+	Comparer->ResetResults();
+	Comparer->CompareVehicleBlueprints(VehicleAssetPath1, VehicleAssetPath2);
+
+	return Comparer->TakeResults();
+}
+
+void UVehicleCompareSubsystem::FlushCaches()
+{
+	if (Comparer)
+	{
+		Comparer->FlushCaches();
+	}
+}
+
+void UVehicleCompareSubsystem::OnBlueprintCompiled()
+{
+	FlushCaches();
+}
+
+void UVehicleCompareSubsystem::OnObjectsReinstanced(const TMap<UObject*, UObject*>& ReplacementMap)
+{
+	FlushCaches();
+}
+
+void UVehicleCompareSubsystem::PostChange(const UUserDefinedEnum* Changed, FEnumEditorUtils::EEnumEditorChangeInfo ChangedType)
+{
+	FlushCaches();
+}
+
+void UVehicleCompareSubsystem::OnPostGarbageCollect()
+{
+	// native classes are never collected, so in practice the caches stay warm until a blueprint class goes
+	if (Comparer && Comparer->HasStaleCaches())
+	{
+		Comparer->FlushCaches();
+	}
+}
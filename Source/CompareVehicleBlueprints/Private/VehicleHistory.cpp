@@ -0,0 +1,354 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "VehicleHistory.h"
+#include "VehicleSnapshot.h"
+#include "VehicleCompareImpl.h"
+#include "CompareVehicleBlueprints.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/PackageName.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	constexpr int32 HistoryVersion = 1;
+
+	const FString MissingValue = "(missing)";
+}
+
+FVehicleHistory::FVehicleHistory()
+{
+	KeyframeInterval = FMath::Max(GetDefault<UCompareVehicleBlueprintsSettings>()->HistoryKeyframeInterval, 1);
+}
+
+FString FVehicleHistory::GetHistoryFile(const FString& VehicleAssetPath)
+{
+	// /Game/Cars/BP_Car.BP_Car -> Saved/CompareVehicleBlueprints/History/Game/Cars/BP_Car.json
+	const FString PackageName = FPackageName::ObjectPathToPackageName(VehicleAssetPath);
+	return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CompareVehicleBlueprints"), TEXT("History"), PackageName.RightChop(1) + TEXT(".json"));
+}
+
+bool FVehicleHistory::RecordRevision(const FString& VehicleAssetPath)
+{
+	UVehicleCompareImpl* Impl = NewObject<UVehicleCompareImpl>();
+
+	FVehicleSnapshot Snapshot;
+	if (!Impl->CaptureVehicleSnapshot(VehicleAssetPath, Snapshot))
+	{
+		return false;
+	}
+
+	// a missing file starts a new history
+	const FString HistoryFile = GetHistoryFile(VehicleAssetPath);
+	FVehicleHistory History;
+	if (FPaths::FileExists(HistoryFile) && !History.LoadFromFile(HistoryFile))
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Warning, TEXT("Cannot read vehicle history %s"), *HistoryFile);
+		return false;
+	}
+
+	const int32 Revision = History.AddRevision(Snapshot, FDateTime::UtcNow());
+	if (Revision == INDEX_NONE)
+	{
+		return true;
+	}
+
+	if (!History.SaveToFile(HistoryFile))
+	{
+		UE_LOG(LogCompareVehicleBlueprints, Warning, TEXT("Cannot write vehicle history %s"), *HistoryFile);
+		return false;
+	}
+
+	UE_LOG(LogCompareVehicleBlueprints, Log, TEXT("Recorded revision %d of %s"), Revision, *VehicleAssetPath);
+	return true;
+}
+
+int32 FVehicleHistory::AddRevision(const FVehicleSnapshot& Snapshot, const FDateTime& Time)
+{
+	// saving without touching the tuning is not a revision, whether or not the next one would be a keyframe
+	if (Revisions.Num() > 0 && Snapshot.Values.OrderIndependentCompareEqual(Head))
+	{
+		return INDEX_NONE;
+	}
+
+	FRevision Revision;
+	Revision.Time = Time;
+	Revision.bKeyframe = Revisions.Num() % KeyframeInterval == 0;
+
+	if (Revision.bKeyframe)
+	{
+		Revision.Set = Snapshot.Values;
+	}
+	else
+	{
+		for (const TPair<FString, FString>& Pair : Snapshot.Values)
+		{
+			const FString* Previous = Head.Find(Pair.Key);
+			if (!Previous || *Previous != Pair.Value)
+			{
+				Revision.Set.Add(Pair.Key, Pair.Value);
+			}
+		}
+
+		for (const TPair<FString, FString>& Pair : Head)
+		{
+			if (!Snapshot.Values.Contains(Pair.Key))
+			{
+				Revision.Removed.Add(Pair.Key);
+			}
+		}
+	}
+
+	VehicleAssetPath = Snapshot.VehicleAssetPath;
+	Head = Snapshot.Values;
+	return Revisions.Add(MoveTemp(Revision));
+}
+
+void FVehicleHistory::ApplyRevision(const FRevision& Revision, TMap<FString, FString>& InOutValues)
+{
+	if (Revision.bKeyframe)
+	{
+		InOutValues = Revision.Set;
+		return;
+	}
+
+	for (const TPair<FString, FString>& Pair : Revision.Set)
+	{
+		InOutValues.Add(Pair.Key, Pair.Value);
+	}
+
+	for (const FString& Path : Revision.Removed)
+	{
+		InOutValues.Remove(Path);
+	}
+}
+
+bool FVehicleHistory::GetValuesAt(int32 Revision, TMap<FString, FString>& OutValues) const
+{
+	if (!Revisions.IsValidIndex(Revision))
+	{
+		return false;
+	}
+
+	// the first revision is always a keyframe, but the interval may have changed since older ones were written
+	int32 Keyframe = Revision;
+	while (!Revisions[Keyframe].bKeyframe)
+	{
+		--Keyframe;
+	}
+
+	OutValues.Reset();
+	for (int32 i = Keyframe; i <= Revision; ++i)
+	{
+		ApplyRevision(Revisions[i], OutValues);
+	}
+
+	return true;
+}
+
+bool FVehicleHistory::GetChangesBetween(int32 FromRevision, int32 ToRevision, TArray<FVehicleHistoryChange>& OutChanges) const
+{
+	TMap<FString, FString> From;
+	TMap<FString, FString> To;
+	if (!GetValuesAt(FromRevision, From) || !GetValuesAt(ToRevision, To))
+	{
+		return false;
+	}
+
+	auto AddChange = [&](const FString& Path, const FString& OldValue, const FString& NewValue)
+	{
+		FVehicleHistoryChange& Change = OutChanges.AddDefaulted_GetRef();
+		Change.Revision = ToRevision;
+		Change.Time = Revisions[ToRevision].Time;
+		Change.Path = Path;
+		Change.OldValue = OldValue;
+		Change.NewValue = NewValue;
+	};
+
+	for (const TPair<FString, FString>& Pair : To)
+	{
+		const FString* OldValue = From.Find(Pair.Key);
+		if (!OldValue || *OldValue != Pair.Value)
+		{
+			AddChange(Pair.Key, OldValue ? *OldValue : MissingValue, Pair.Value);
+		}
+	}
+
+	for (const TPair<FString, FString>& Pair : From)
+	{
+		if (!To.Contains(Pair.Key))
+		{
+			AddChange(Pair.Key, Pair.Value, MissingValue);
+		}
+	}
+
+	return true;
+}
+
+TArray<FVehicleHistoryChange> FVehicleHistory::FindChanges(const FString& PathWildcard) const
+{
+	TArray<FVehicleHistoryChange> Changes;
+
+	// replay only the matching properties, a keyframe shows a change only if its value differs from the replayed one
+	TMap<FString, FString> Values;
+
+	for (int32 RevisionIndex = 0; RevisionIndex < Revisions.Num(); ++RevisionIndex)
+	{
+		const FRevision& Revision = Revisions[RevisionIndex];
+
+		auto SetValue = [&](const FString& Path, const FString& NewValue)
+		{
+			FString* OldValue = Values.Find(Path);
+			const FString OldValueOrMissing = OldValue ? *OldValue : MissingValue;
+
+			if (OldValueOrMissing != NewValue && RevisionIndex > 0)
+			{
+				FVehicleHistoryChange& Change = Changes.AddDefaulted_GetRef();
+				Change.Revision = RevisionIndex;
+				Change.Time = Revision.Time;
+				Change.Path = Path;
+				Change.OldValue = OldValueOrMissing;
+				Change.NewValue = NewValue;
+			}
+
+			if (NewValue == MissingValue)
+			{
+				Values.Remove(Path);
+			}
+			else
+			{
+				Values.Add(Path, NewValue);
+			}
+		};
+
+		for (const TPair<FString, FString>& Pair : Revision.Set)
+		{
+			if (Pair.Key.MatchesWildcard(PathWildcard))
+			{
+				SetValue(Pair.Key, Pair.Value);
+			}
+		}
+
+		for (const FString& Path : Revision.Removed)
+		{
+			if (Path.MatchesWildcard(PathWildcard))
+			{
+				SetValue(Path, MissingValue);
+			}
+		}
+
+		// properties a keyframe does not mention were removed
+		if (Revision.bKeyframe)
+		{
+			TArray<FString> Paths;
+			Values.GetKeys(Paths);
+			for (const FString& Path : Paths)
+			{
+				if (!Revision.Set.Contains(Path))
+				{
+					SetValue(Path, MissingValue);
+				}
+			}
+		}
+	}
+
+	return Changes;
+}
+
+bool FVehicleHistory::SaveToFile(const FString& FileName) const
+{
+	TArray<TSharedPtr<FJsonValue>> RevisionValues;
+
+	for (const FRevision& Revision : Revisions)
+	{
+		TSharedRef<FJsonObject> SetObject = MakeShared<FJsonObject>();
+		for (const TPair<FString, FString>& Pair : Revision.Set)
+		{
+			SetObject->SetStringField(Pair.Key, Pair.Value);
+		}
+
+		TArray<TSharedPtr<FJsonValue>> RemovedValues;
+		for (const FString& Path : Revision.Removed)
+		{
+			RemovedValues.Add(MakeShared<FJsonValueString>(Path));
+		}
+
+		TSharedRef<FJsonObject> RevisionObject = MakeShared<FJsonObject>();
+		RevisionObject->SetStringField("Time", Revision.Time.ToIso8601());
+		RevisionObject->SetBoolField("Keyframe", Revision.bKeyframe);
+		RevisionObject->SetObjectField("Set", SetObject);
+		if (RemovedValues.Num() > 0)
+		{
+			RevisionObject->SetArrayField("Removed", RemovedValues);
+		}
+		RevisionValues.Add(MakeShared<FJsonValueObject>(RevisionObject));
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField("Version", HistoryVersion);
+	Root->SetStringField("Vehicle", VehicleAssetPath);
+	Root->SetArrayField("Revisions", RevisionValues);
+
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	if (!FJsonSerializer::Serialize(Root, Writer))
+	{
+		return false;
+	}
+
+	return FFileHelper::SaveStringToFile(Text, *FileName, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+bool FVehicleHistory::LoadFromFile(const FString& FileName)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FileName))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Text);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+	{
+		return false;
+	}
+
+	if (Root->GetIntegerField("Version") != HistoryVersion)
+	{
+		return false;
+	}
+
+	VehicleAssetPath = Root->GetStringField("Vehicle");
+	Revisions.Reset();
+	Head.Reset();
+
+	for (const TSharedPtr<FJsonValue>& RevisionValue : Root->GetArrayField("Revisions"))
+	{
+		const TSharedPtr<FJsonObject>& RevisionObject = RevisionValue->AsObject();
+
+		FRevision& Revision = Revisions.AddDefaulted_GetRef();
+		FDateTime::ParseIso8601(*RevisionObject->GetStringField("Time"), Revision.Time);
+		Revision.bKeyframe = RevisionObject->GetBoolField("Keyframe") || Revisions.Num() == 1;
+
+		const TSharedPtr<FJsonObject>* SetObject = nullptr;
+		if (RevisionObject->TryGetObjectField("Set", SetObject))
+		{
+			for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*SetObject)->Values)
+			{
+				Revision.Set.Add(Pair.Key, Pair.Value->AsString());
+			}
+		}
+
+		RevisionObject->TryGetStringArrayField("Removed", Revision.Removed);
+
+		// keep the newest values so the next save can be stored as a delta
+		ApplyRevision(Revision, Head);
+	}
+
+	return true;
+}
@@ -0,0 +1,251 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "VehiclePreparation.h"
+#include "CompareVehicleBlueprintsSettings.h"
+#include "EditorAssetLibrary.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectGlobals.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "ChaosWheeledVehicleMovementComponent.h"
+
+TSharedRef<FVehiclePreparation> FVehiclePreparation::Start(const TArray<FString>& VehicleAssetPaths, FOnProgress OnProgress, FOnFinished OnFinished)
+{
+	TSharedRef<FVehiclePreparation> Preparation = MakeShareable(new FVehiclePreparation(VehicleAssetPaths, MoveTemp(OnProgress), MoveTemp(OnFinished)));
+
+	// the ticker only holds a weak pointer, dropping the preparation stops it
+	Preparation->TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(Preparation, &FVehiclePreparation::Tick));
+
+	return Preparation;
+}
+
+FVehiclePreparation::FVehiclePreparation(const TArray<FString>& InVehicleAssetPaths, FOnProgress InOnProgress, FOnFinished InOnFinished)
+	: VehicleAssetPaths(InVehicleAssetPaths)
+	, OnProgress(MoveTemp(InOnProgress))
+	, OnFinished(MoveTemp(InOnFinished))
+{
+	Vehicles.SetNum(VehicleAssetPaths.Num());
+
+	for (int32 i = 0; i < VehicleAssetPaths.Num(); ++i)
+	{
+		Vehicles[i].AssetPath = VehicleAssetPaths[i];
+	}
+
+	FrameBudgetSeconds = GetDefault<UCompareVehicleBlueprintsSettings>()->PreparationFrameBudgetMs / 1000.0f;
+}
+
+FVehiclePreparation::~FVehiclePreparation()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+}
+
+void FVehiclePreparation::Cancel()
+{
+	if (bFinished)
+	{
+		return;
+	}
+
+	// OnFinished may release the last reference to us
+	TSharedRef<FVehiclePreparation> KeepAlive = AsShared();
+
+	bCancelled = true;
+	Finish();
+}
+
+float FVehiclePreparation::GetProgress() const
+{
+	if (bFinished || Vehicles.Num() == 0)
+	{
+		return 1.0f;
+	}
+
+	return static_cast<float>(VehicleIndex) / Vehicles.Num();
+}
+
+bool FVehiclePreparation::Tick(float DeltaTime)
+{
+	if (bFinished)
+	{
+		return false;
+	}
+
+	TSharedRef<FVehiclePreparation> KeepAlive = AsShared();
+
+	const double EndTime = FPlatformTime::Seconds() + FrameBudgetSeconds;
+
+	// always at least one step, so a budget smaller than a step still gets through the vehicles
+	do
+	{
+		if (!Step())
+		{
+			break;
+		}
+	}
+	while (!bFinished && FPlatformTime::Seconds() < EndTime);
+
+	if (!bFinished && OnProgress)
+	{
+		OnProgress(GetProgress(), "Preparing " + VehicleAssetPaths[VehicleIndex]);
+	}
+
+	return !bFinished;
+}
+
+bool FVehiclePreparation::Step()
+{
+	if (VehicleIndex >= Vehicles.Num())
+	{
+		Finish();
+		return false;
+	}
+
+	FVehicleComponents& Vehicle = Vehicles[VehicleIndex];
+
+	switch (CurrentStep)
+	{
+	case EStep::Load:
+	{
+		// reading the package and most of post-load happen in the async loader, spread over frames by its own time limit
+		CurrentStep = EStep::WaitForLoad;
+		LoadPackageAsync(FPackageName::ObjectPathToPackageName(Vehicle.AssetPath), FLoadPackageAsyncDelegate::CreateSP(this, &FVehiclePreparation::OnPackageLoaded));
+		return CurrentStep != EStep::WaitForLoad;
+	}
+
+	case EStep::WaitForLoad:
+		return false;
+
+	case EStep::Gather:
+	{
+		// the package is in memory so this only finds the asset
+		UBlueprint* Blueprint = Cast<UBlueprint>(UEditorAssetLibrary::LoadAsset(Vehicle.AssetPath));
+		if (!Blueprint)
+		{
+			AddError("Cannot load blueprint \"" + Vehicle.AssetPath + "\"");
+		}
+		else
+		{
+			// a walk over pointers the blueprint already has, short enough not to need slicing
+			Vehicle.GatherComponents(Blueprint);
+		}
+
+		NextVehicle();
+		return true;
+	}
+	}
+
+	return false;
+}
+
+void FVehiclePreparation::OnPackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result)
+{
+	if (bFinished || CurrentStep != EStep::WaitForLoad)
+	{
+		return;
+	}
+
+	if (Result != EAsyncLoadingResult::Succeeded || !Package)
+	{
+		TSharedRef<FVehiclePreparation> KeepAlive = AsShared();
+
+		AddError("Cannot load blueprint \"" + Vehicles[VehicleIndex].AssetPath + "\"");
+		NextVehicle();
+		return;
+	}
+
+	CurrentStep = EStep::Gather;
+}
+
+void FVehiclePreparation::NextVehicle()
+{
+	++VehicleIndex;
+	CurrentStep = EStep::Load;
+
+	if (VehicleIndex >= Vehicles.Num())
+	{
+		Finish();
+	}
+}
+
+void FVehiclePreparation::Finish()
+{
+	if (bFinished)
+	{
+		return;
+	}
+
+	bFinished = true;
+
+	// the editor kept running while we prepared, a vehicle compiled in the meantime has new templates
+	if (!bCancelled)
+	{
+		for (int32 i = 0; i < Vehicles.Num(); ++i)
+		{
+			FVehicleComponents& Vehicle = Vehicles[i];
+			if (!Vehicle.Blueprint || Vehicle.AreComponentsValid())
+			{
+				continue;
+			}
+
+			if (IsValid(Vehicle.Blueprint))
+			{
+				Vehicle.GatherComponents(Vehicle.Blueprint);
+			}
+			else
+			{
+				AddError("Blueprint \"" + Vehicle.AssetPath + "\" was deleted while it was being prepared");
+				Vehicle = FVehicleComponents();
+				Vehicle.AssetPath = VehicleAssetPaths[i];
+			}
+		}
+	}
+
+	if (OnProgress)
+	{
+		OnProgress(1.0f, bCancelled ? FString("Cancelled") : "Prepared " + FString::FromInt(Vehicles.Num()) + " vehicles");
+	}
+
+	if (OnFinished)
+	{
+		OnFinished(*this);
+	}
+}
+
+void FVehiclePreparation::AddError(const FString& Message)
+{
+	TSharedRef<FDifference> Diff = MakeShared<FDifference>();
+	Diff->Type = EDifferenceType::Error;
+	Diff->Message = Message;
+	Messages.Add(Diff);
+}
+
+void FVehiclePreparation::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	// the templates too, until Finish() checks them they are only held by raw pointers
+	for (FVehicleComponents& Vehicle : Vehicles)
+	{
+		if (Vehicle.Blueprint)
+		{
+			Collector.AddReferencedObject(Vehicle.Blueprint);
+		}
+
+		for (const UObject*& Object : Vehicle.Subobjects)
+		{
+			Collector.AddReferencedObject(Object);
+		}
+
+		for (const USkeletalMeshComponent*& Component : Vehicle.SkeletalMeshComponents)
+		{
+			Collector.AddReferencedObject(Component);
+		}
+
+		for (const UChaosWheeledVehicleMovementComponent*& Component : Vehicle.VehicleMovementComponents)
+		{
+			Collector.AddReferencedObject(Component);
+		}
+	}
+}
+
+FString FVehiclePreparation::GetReferencerName() const
+{
+	return TEXT("FVehiclePreparation");
+}
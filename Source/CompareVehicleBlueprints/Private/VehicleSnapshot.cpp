@@ -0,0 +1,71 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#include "VehicleSnapshot.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace
+{
+	constexpr int32 SnapshotVersion = 1;
+}
+
+bool FVehicleSnapshot::SaveToFile(const FString& FileName) const
+{
+	TSharedRef<FJsonObject> ValuesObject = MakeShared<FJsonObject>();
+	for (const TPair<FString, FString>& Pair : Values)
+	{
+		ValuesObject->SetStringField(Pair.Key, Pair.Value);
+	}
+
+	TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+	Root->SetNumberField("Version", SnapshotVersion);
+	Root->SetStringField("Vehicle", VehicleAssetPath);
+	Root->SetObjectField("Values", ValuesObject);
+
+	FString Text;
+	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Text);
+	if (!FJsonSerializer::Serialize(Root, Writer))
+	{
+		return false;
+	}
+
+	return FFileHelper::SaveStringToFile(Text, *FileName, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+bool FVehicleSnapshot::LoadFromFile(const FString& FileName)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FileName))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Text);
+	if (!FJsonSerializer::Deserialize(Reader, Root) || !Root.IsValid())
+	{
+		return false;
+	}
+
+	if (Root->GetIntegerField("Version") != SnapshotVersion)
+	{
+		return false;
+	}
+
+	VehicleAssetPath = Root->GetStringField("Vehicle");
+	Values.Reset();
+
+	const TSharedPtr<FJsonObject>* ValuesObject = nullptr;
+	if (Root->TryGetObjectField("Values", ValuesObject))
+	{
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : (*ValuesObject)->Values)
+		{
+			Values.Add(Pair.Key, Pair.Value->AsString());
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,50 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Difference.h"
+
+class UBlueprint;
+class UEdGraph;
+class UEdGraphNode;
+class UEdGraphPin;
+
+// compares the graphs of two blueprints. Graphs are matched by name and nodes by NodeGuid, falling back to the
+// title and then the nearest position for nodes which were recreated. Matching by guid is linear in the number of
+// nodes. The fallback only searches the candidates with the same title in a small area around each node, so it stays
+// close to linear unless many same-titled nodes are stacked in one spot
+class COMPAREVEHICLEBLUEPRINTS_API FBlueprintGraphComparer
+{
+public:
+	void Compare(const FString& PathA, const FString& PathB, const UBlueprint* A, const UBlueprint* B);
+
+	const TArray<TSharedRef<FDifference>>& GetResults() const { return Results; }
+
+private:
+	void CompareGraphs(const FString& PathA, const FString& PathB, const UEdGraph* A, const UEdGraph* B);
+
+	// B node for every A node which has one
+	void MatchNodes(const UEdGraph* A, const UEdGraph* B, TMap<const UEdGraphNode*, const UEdGraphNode*>& OutMatches) const;
+
+	void CompareNodes(const FString& PathA, const FString& PathB, const UEdGraphNode* A, const UEdGraphNode* B,
+		const TMap<const UEdGraphNode*, const UEdGraphNode*>& Matches);
+
+	void ComparePinLinks(const FString& PathA, const FString& PathB, const UEdGraphPin* A, const UEdGraphPin* B,
+		const TMap<const UEdGraphNode*, const UEdGraphNode*>& Matches);
+
+	// unique within the graph and safe in a '/' separated path
+	static FString GetNodeName(const UEdGraphNode* Node);
+
+	// the title shown on the node, on one line, for messages and values
+	static FString GetNodeTitle(const UEdGraphNode* Node);
+
+	// where a pin's rows go below its node, inputs and outputs can share a name
+	static FString GetPinPath(const FString& NodePath, const UEdGraphPin* Pin);
+
+	void AddMessage(const FString& Message, EDifferenceType Type);
+	void AddDifference(const FString& PathA, const FString& PathB, const FString& ValueA, const FString& ValueB);
+
+private:
+	TArray<TSharedRef<FDifference>> Results;
+};
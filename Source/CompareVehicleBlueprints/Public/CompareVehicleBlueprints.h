@@ -5,11 +5,15 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogCompareVehicleBlueprints, Log, All);
+
 class FToolBarBuilder;
 class FMenuBuilder;
 
 class SMainWindow;
 class FInputData;
+class UPackage;
+class FObjectPostSaveContext;
 
 class FCompareVehicleBlueprintsModule : public IModuleInterface
 {
@@ -28,6 +32,9 @@ private:
 
 	TSharedRef<class SDockTab> OnSpawnPluginTab(const class FSpawnTabArgs& SpawnTabArgs);
 
+	// add saved vehicles to their tuning history
+	void OnPackageSaved(const FString& PackageFileName, UPackage* Package, FObjectPostSaveContext Context);
+
 private:
 	TSharedPtr<class FUICommandList> PluginCommands;
 
@@ -37,5 +44,7 @@ private:
 	// input data
 	TSharedPtr < FInputData > InputData;
 
+	FDelegateHandle PackageSavedHandle;
+
 
 };
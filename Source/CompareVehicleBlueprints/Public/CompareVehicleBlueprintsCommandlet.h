@@ -0,0 +1,70 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "Difference.h"
+#include "CompareVehicleBlueprintsCommandlet.generated.h"
+
+/**
+ * run comparisons from the command line, for example in CI
+ *
+ * record a golden snapshot of a vehicle:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=Record -Vehicle=/Game/Cars/BP_Car.BP_Car -Snapshot=Golden/BP_Car.json
+ *
+ * check a vehicle against its snapshot, returns non-zero if there are differences which are not allowed:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=Verify -Vehicle=/Game/Cars/BP_Car.BP_Car -Snapshot=Golden/BP_Car.json
+ *      [-Allow=VehicleMovementComp.Mass,*.bCastShadow] [-AllowList=Golden/Allow.txt]
+ *
+ * list every wheeled vehicle blueprint, found from asset registry tags without loading anything:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=List [-Path=/Game/Cars,/Game/Trucks] [-Name=BP_*]
+ *
+ * find components, structs and arrays which are identical on several vehicles and could be shared through data assets:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=Duplicates -Fleet [-MinVehicles=2] [-MinSize=2]
+ *
+ * show how a vehicle's tuning changed, from the history recorded on save. Either between two revisions (by default the
+ * last two) or every revision in which properties matching a wildcard changed:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=History -Vehicle=/Game/Cars/BP_Car.BP_Car [-From=3 -To=7] [-Property=*.MaxRPM]
+ *
+ * record and verify accept the same -Path/-Name filters, or -Fleet for all content, in place of -Vehicle.
+ * Each vehicle then uses <SnapshotDir>/<package path>.json:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=Verify -Path=/Game/Cars -SnapshotDir=Golden
+ *
+ * a large fleet can be split across worker processes, each restarted after -AssetsPerWorker vehicles, with the
+ * results merged in fleet order and optionally written to a report:
+ *   UnrealEditor-Cmd.exe Project.uproject -run=CompareVehicleBlueprints -Mode=Verify -Fleet -SnapshotDir=Golden -Workers=8 [-AssetsPerWorker=100] [-Report=Fleet.json]
+ */
+UCLASS()
+class UCompareVehicleBlueprintsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCompareVehicleBlueprintsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	// the vehicles named by -Vehicle, or found from -Path, -Name and -Fleet
+	TArray<FString> FindVehicles(const FString& Params) const;
+
+	// wildcards from -Allow and -AllowList, returns false if the allow list file cannot be read
+	bool ReadAllowList(const FString& Params, TArray<FString>& OutAllowList) const;
+
+	static FString SnapshotFileForVehicle(const FString& SnapshotDir, const FString& VehicleAssetPath);
+
+	void Record(const FString& VehicleAssetPath, const FString& SnapshotFile, struct FFleetVehicleResult& OutResult);
+	void Verify(const FString& VehicleAssetPath, const FString& SnapshotFile, const TArray<FString>& AllowList, struct FFleetVehicleResult& OutResult);
+
+	static void AddResult(struct FFleetVehicleResult& OutResult, EDifferenceType Type, const FString& Message);
+
+	// log changes from a vehicle's history
+	int32 ShowHistory(const FString& VehicleAssetPath, const FString& Params);
+
+	// log groups of identical subtrees shared by at least MinVehicles vehicles
+	int32 FindDuplicates(const TArray<FString>& Vehicles, int32 MinVehicles, int32 MinSize);
+
+	// write results to the log
+	void LogResults(const TArray<TSharedRef<FDifference>>& Results) const;
+};
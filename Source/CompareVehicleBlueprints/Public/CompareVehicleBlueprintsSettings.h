@@ -0,0 +1,79 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "CompareVehicleBlueprintsSettings.generated.h"
+
+/**
+ * project settings for vehicle comparison, saved to DefaultEditor.ini so a team shares them
+ */
+UCLASS(config = Editor, defaultconfig, meta = (DisplayName = "Compare Vehicle Blueprints"))
+class COMPAREVEHICLEBLUEPRINTS_API UCompareVehicleBlueprintsSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UCompareVehicleBlueprintsSettings();
+
+	virtual FName GetCategoryName() const override { return TEXT("Plugins"); }
+
+public:
+	// property paths to compare, relative to the component and separated by '.', e.g. "EngineSetup.*" or "WheelSetups.BoneName".
+	// '*' and '?' match within one property name, "**" matches any number of names. When empty everything is compared
+	UPROPERTY(config, EditAnywhere, Category = "Filter")
+	TArray<FString> IncludePaths;
+
+	// property paths to skip, along with everything below them, e.g. "LODInfo" or "**.bCastShadow"
+	UPROPERTY(config, EditAnywhere, Category = "Filter")
+	TArray<FString> ExcludePaths;
+
+	// property categories to skip, e.g. "Rendering", "LOD" or "Audio". Subcategories such as "Rendering|Lighting" are skipped with their parent
+	UPROPERTY(config, EditAnywhere, Category = "Filter")
+	TArray<FString> ExcludeCategories;
+
+	// skip properties shown in the advanced section of the details panel
+	UPROPERTY(config, EditAnywhere, Category = "Filter")
+	bool bExcludeAdvancedDisplay = false;
+
+	// skip transient properties, they are not saved with the blueprint
+	UPROPERTY(config, EditAnywhere, Category = "Filter")
+	bool bExcludeTransient = false;
+
+	// also compare the event graphs, functions and macros of the two blueprints, node by node
+	UPROPERTY(config, EditAnywhere, Category = "Comparison")
+	bool bCompareGraphs = true;
+
+	// compare the top level properties of a component on task graph workers, the output is the same as a serial run
+	UPROPERTY(config, EditAnywhere, Category = "Performance")
+	bool bParallelTraversal = true;
+
+	// estimated number of properties to compare in a component below which the comparison stays on one thread
+	UPROPERTY(config, EditAnywhere, Category = "Performance", meta = (ClampMin = 0, EditCondition = "bParallelTraversal"))
+	int32 MinParallelTraversalSize = 512;
+
+	// game thread time (ms) preparing vehicles may take each frame in the editor, loading and gathering components is spread over frames to stay within it
+	UPROPERTY(config, EditAnywhere, Category = "Performance", meta = (ClampMin = 0.5))
+	float PreparationFrameBudgetMs = 5.0f;
+
+	// when processing a fleet, unload the vehicles processed so far once the editor uses more than this much physical memory (MB). 0 for no limit
+	UPROPERTY(config, EditAnywhere, Category = "Fleet", meta = (ClampMin = 0))
+	int32 FleetWorkingSetBudgetMB = 8192;
+
+	// when processing a fleet, unload the vehicles processed so far at least this often. 0 to only unload when over budget
+	UPROPERTY(config, EditAnywhere, Category = "Fleet", meta = (ClampMin = 0))
+	int32 FleetMaxVehiclesPerBatch = 64;
+
+	// when a fleet job is split across worker processes, each worker exits after this many vehicles and a new one takes the next shard. 0 to split the fleet evenly
+	UPROPERTY(config, EditAnywhere, Category = "Fleet", meta = (ClampMin = 0))
+	int32 FleetAssetsPerWorker = 100;
+
+	// each time a wheeled vehicle blueprint is saved, append the values it would be compared on to its history in Saved/CompareVehicleBlueprints/History
+	UPROPERTY(config, EditAnywhere, Category = "History")
+	bool bRecordHistoryOnSave = false;
+
+	// store every value in one history revision out of this many, the others only store what changed
+	UPROPERTY(config, EditAnywhere, Category = "History", meta = (ClampMin = 1, EditCondition = "bRecordHistoryOnSave"))
+	int32 HistoryKeyframeInterval = 32;
+};
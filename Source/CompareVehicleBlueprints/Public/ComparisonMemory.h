@@ -0,0 +1,15 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Misc/MemStack.h"
+
+// what the plugin allocates while loading and comparing vehicles, shown under this tag with -llm and in memreport
+LLM_DECLARE_TAG_API(CompareVehicleBlueprints, COMPAREVEHICLEBLUEPRINTS_API);
+
+// short lived arrays for one step of a comparison come from the FMemStack of the thread doing the work. The pages are
+// reused and freed together when the FMemMark taken on that thread goes out of scope, threads never share a page
+template <typename ElementType>
+using TScratchArray = TArray<ElementType, TMemStackAllocator<>>;
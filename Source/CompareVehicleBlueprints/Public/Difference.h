@@ -23,4 +23,10 @@ public:
 	FString Message;
 
 	EDifferenceType Type;
+
+	// for differences in a component, the side A template and the path to the value, e.g. "EngineSetup.MaxRPM".
+	// Used to copy the value to other vehicles, Component is None when that is not possible
+	FName Component;
+
+	FString PropertyPath;
 };
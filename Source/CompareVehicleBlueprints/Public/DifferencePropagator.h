@@ -0,0 +1,34 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Difference.h"
+
+struct FVehicleComponents;
+class UActorComponent;
+
+// copies values found to differ from the vehicle they were read from (side A of a comparison) to other vehicle blueprints.
+// Edits are grouped by target, each target gets one transaction, is marked modified once and compiled once
+class COMPAREVEHICLEBLUEPRINTS_API FDifferencePropagator
+{
+public:
+	// returns the number of values set over all targets, what was done and anything skipped is added to OutMessages
+	int32 Apply(const FString& SourceVehicleAssetPath, const TArray<TSharedRef<FDifference>>& Differences,
+		const TArray<FString>& TargetVehicleAssetPaths, TArray<TSharedRef<FDifference>>& OutMessages);
+
+	// the same for vehicles which are already loaded, targets with a null Blueprint are skipped
+	int32 Apply(const FVehicleComponents& Source, const TArray<TSharedRef<FDifference>>& Differences,
+		const TArray<FVehicleComponents>& Targets, TArray<TSharedRef<FDifference>>& OutMessages);
+
+private:
+	// a component template with the same name, templates of blueprint components are named after their variable
+	static UObject* FindComponent(const FVehicleComponents& Vehicle, FName ComponentName);
+
+	// the target's own template of a component, which may be edited. A component inherited from a parent blueprint
+	// gets an override in the target's InheritableComponentHandler, so the parent asset is never changed. Null with
+	// OutError set if there is no such template
+	static UObject* GetEditableComponent(const FVehicleComponents& Target, FName ComponentName, FString& OutError);
+
+	static void AddMessage(TArray<TSharedRef<FDifference>>& OutMessages, const FString& Message, EDifferenceType Type);
+};
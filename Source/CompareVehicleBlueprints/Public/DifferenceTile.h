@@ -12,6 +12,7 @@ class SButton;
 class SCheckBox;
 
 
+// a row of the results list, each column is a single widget which paints its text directly
 class SDifferenceTile : public SMultiColumnTableRow<TSharedPtr< FDifference > >
 {
 	SLATE_BEGIN_ARGS(SDifferenceTile) 
@@ -24,11 +25,19 @@ class SDifferenceTile : public SMultiColumnTableRow<TSharedPtr< FDifference > >
 	SLATE_END_ARGS()
 
 public:
+	SDifferenceTile();
+	virtual ~SDifferenceTile();
+
 	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTableView);
 
 	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override;
 
+	// rows and cells alive now, for the stats footer
+	static int32 GetNumLiveWidgets();
+
+	// time spent painting cells since the last call
+	static double ConsumePaintSeconds();
+
 private:
 	TSharedPtr<FDifference> Item;
 };
-
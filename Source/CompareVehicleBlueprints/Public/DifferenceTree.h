@@ -0,0 +1,79 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/Views/STableRow.h"
+#include "Difference.h"
+
+// one level of the component/struct/array hierarchy in the tree view. A node only holds a range of the
+// sorted differences below it, its children are made the first time it is expanded, so the cost of
+// showing a comparison depends on what is opened rather than on how many differences there are
+class FDifferenceTreeNode
+{
+public:
+	// put differences in tree order, messages first then paths with each level grouped together
+	static void SortForTree(TArray<TSharedRef<FDifference>>& Differences);
+
+	// the top of a tree over differences sorted with SortForTree
+	static TSharedRef<FDifferenceTreeNode> MakeRoot(const TSharedRef<const TArray<TSharedRef<FDifference>>>& SortedDifferences);
+
+	// built on first use
+	const TArray<TSharedRef<FDifferenceTreeNode>>& GetChildren();
+
+	bool HasChildren() const { return ChildrenFirst < Last; }
+
+	// differences below this node, not counting one on the node itself
+	int32 GetNumDifferencesBelow() const { return Last - ChildrenFirst; }
+
+public:
+	// property, component or array element name, empty for messages
+	FString Name;
+
+	// set when a difference is on this node itself
+	TSharedPtr<FDifference> Difference;
+
+private:
+	FDifferenceTreeNode(const TSharedRef<const TArray<TSharedRef<FDifference>>>& InDifferences, int32 InFirst, int32 InLast, int32 InPrefixLength);
+
+	// the path a difference is placed at, its side A path without the vehicle name
+	static const TCHAR* GetTreePath(const FDifference& Diff);
+
+	// the part of a difference's tree path below this node, empty if the path ends at or above it
+	const TCHAR* GetPathBelow(const FDifference& Diff) const;
+
+	void BuildChildren();
+
+private:
+	TSharedRef<const TArray<TSharedRef<FDifference>>> Differences;
+
+	// range of Differences below this node, the children cover ChildrenFirst to Last
+	int32 First = 0;
+	int32 Last = 0;
+	int32 ChildrenFirst = 0;
+
+	// characters of the tree path taken by this node and its parents
+	int32 PrefixLength = 0;
+
+	bool bChildrenBuilt = false;
+	TArray<TSharedRef<FDifferenceTreeNode>> Children;
+};
+
+// row of the tree view: the hierarchy on the left, the two vehicles' values side by side
+class SDifferenceTreeRow : public SMultiColumnTableRow<TSharedRef<FDifferenceTreeNode>>
+{
+	SLATE_BEGIN_ARGS(SDifferenceTreeRow)
+	{
+	}
+
+	SLATE_ARGUMENT(TSharedPtr<FDifferenceTreeNode>, InItem)
+	SLATE_END_ARGS()
+
+public:
+	void Construct(const FArguments& InArgs, const TSharedRef<STableViewBase>& InOwnerTableView);
+
+	virtual TSharedRef<SWidget> GenerateWidgetForColumn(const FName& ColumnName) override;
+
+private:
+	TSharedPtr<FDifferenceTreeNode> Item;
+};
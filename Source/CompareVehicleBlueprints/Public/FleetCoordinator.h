@@ -0,0 +1,73 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+#include "Difference.h"
+
+// what one vehicle of a fleet job produced
+struct FFleetVehicleResult
+{
+	FString VehicleAssetPath;
+
+	bool bFailed = false;
+
+	TArray<TSharedRef<FDifference>> Results;
+};
+
+// the results of a fleet job in fleet order. Workers write one per shard and the coordinator merges them
+class COMPAREVEHICLEBLUEPRINTS_API FFleetReport
+{
+public:
+	bool SaveToFile(const FString& FileName) const;
+	bool LoadFromFile(const FString& FileName);
+
+	int32 GetNumFailed() const;
+
+public:
+	TArray<FFleetVehicleResult> Vehicles;
+};
+
+// splits a fleet job into shards and runs each shard in its own headless editor process, several at once.
+// A worker only ever processes one shard, so limiting the shard size restarts workers regularly and
+// bounds whatever they leak. Shards are contiguous runs of the fleet, merging them in shard order gives
+// the same report however many workers there are and whichever finishes first
+class COMPAREVEHICLEBLUEPRINTS_API FFleetCoordinator
+{
+public:
+	// limits come from the project settings
+	FFleetCoordinator();
+
+	// run the commandlet in Mode on every vehicle, WorkerArgs are added to each worker's command line.
+	// Returns false if no worker could be started, a shard whose worker dies is reported as failed vehicles
+	bool Run(const TArray<FString>& VehicleAssetPaths, const FString& Mode, const FString& WorkerArgs, FFleetReport& OutReport);
+
+public:
+	// worker processes to run at the same time
+	int32 NumWorkers = 1;
+
+	// vehicles each worker process handles before it exits
+	int32 AssetsPerWorker = 0;
+
+	// where asset lists, result files and worker logs are written
+	FString WorkDir;
+
+private:
+	struct FShard
+	{
+		int32 First = 0;
+		int32 Num = 0;
+
+		FString AssetListFile;
+		FString ResultFile;
+		FString LogFile;
+
+		FProcHandle Process;
+	};
+
+	bool LaunchWorker(FShard& Shard, const FString& Mode, const FString& WorkerArgs) const;
+
+	// add the shard's results to the report, or mark its vehicles failed if the worker did not finish
+	void MergeShard(const FShard& Shard, int32 ReturnCode, const TArray<FString>& VehicleAssetPaths, FFleetReport& OutReport) const;
+};
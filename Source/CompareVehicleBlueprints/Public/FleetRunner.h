@@ -0,0 +1,44 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPackage;
+
+// runs a function over many vehicles while keeping memory bounded. Packages loaded by a batch of
+// vehicles are detached from their loaders and garbage collected when the working set goes over
+// budget, or after a fixed number of vehicles, so peak memory does not grow with the fleet size
+class COMPAREVEHICLEBLUEPRINTS_API FFleetRunner
+{
+public:
+	// budgets come from the project settings
+	FFleetRunner();
+
+	// Extract is called once per vehicle. It may load the vehicle but must only keep plain data
+	// (snapshots, hashes, results), anything it loaded can be collected once it returns
+	void Run(const TArray<FString>& VehicleAssetPaths, TFunctionRef<void(const FString& VehicleAssetPath)> Extract);
+
+	int32 GetNumReleases() const { return NumReleases; }
+	uint64 GetPeakUsedPhysical() const { return PeakUsedPhysical; }
+
+public:
+	// release loaded packages when the process uses more than this many bytes of physical memory
+	uint64 WorkingSetBudget = 0;
+
+	// release loaded packages at least this often, 0 for only when over budget
+	int32 MaxVehiclesPerBatch = 0;
+
+private:
+	// remember the packages loaded before a batch, they are left alone
+	void BeginBatch();
+
+	// reset the loaders of packages the batch loaded and collect garbage
+	void ReleaseBatch();
+
+private:
+	TSet<const UPackage*> PackagesBeforeBatch;
+
+	int32 NumReleases = 0;
+	uint64 PeakUsedPhysical = 0;
+};
@@ -0,0 +1,63 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVehicleComponents;
+
+// one component, struct or array value of one vehicle, identified by a hash of its contents
+struct FSubtreeRecord
+{
+	FString VehicleAssetPath;
+
+	// e.g. "VehicleMovementComp.EngineSetup" or "VehicleMovementComp.WheelSetups[2]"
+	FString Path;
+
+	// struct or class name, subtrees of different types are never grouped together
+	FString TypeName;
+
+	uint64 Hash = 0;
+
+	// number of leaf values in the subtree
+	int32 Size = 0;
+
+	// the record this one is inside, INDEX_NONE for components
+	int32 ParentRecord = INDEX_NONE;
+};
+
+// subtrees with the same type and contents found on several vehicles
+struct FDuplicateSubtreeGroup
+{
+	FString TypeName;
+	uint64 Hash = 0;
+	int32 Size = 0;
+
+	// the records in the group, sorted by vehicle then path. They point into the index they came from
+	TArray<const FSubtreeRecord*> Members;
+
+	int32 NumVehicles = 0;
+};
+
+// hashes every component and struct/array subtree of each vehicle in a fleet so identical copies, which
+// could be shared through data assets, are found with one hash table lookup per subtree
+class COMPAREVEHICLEBLUEPRINTS_API FFleetSubtreeIndex
+{
+public:
+	void AddVehicle(const FString& VehicleAssetPath, const FVehicleComponents& Components);
+
+	// groups shared by at least MinVehicles vehicles with at least MinSize values, biggest saving first.
+	// A group is left out when it only repeats a larger group, e.g. the torque curve inside an identical engine setup
+	TArray<FDuplicateSubtreeGroup> FindDuplicates(int32 MinVehicles = 2, int32 MinSize = 2) const;
+
+	const TArray<FSubtreeRecord>& GetRecords() const { return Records; }
+
+private:
+	void AddComponent(const FString& VehicleAssetPath, UClass* Class, const UObject* Component);
+
+	// returns the hash of the value at PropertyAddr, adding records for structs and arrays
+	uint64 HashValue(const FString& VehicleAssetPath, const FString& Path, int32 ParentRecord, const FProperty* Property, const uint8* PropertyAddr, int32& OutSize);
+
+private:
+	TArray<FSubtreeRecord> Records;
+};
@@ -4,6 +4,9 @@
 
 #include "Widgets/SCompoundWidget.h"
 #include "Difference.h"
+#include "VehicleAssetFilter.h"
+#include "DifferenceTree.h"
+#include "VehiclePreparation.h"
 
 class FInputData;
 
@@ -22,13 +25,28 @@ class SMainWindow : public SCompoundWidget
 	/** Widget constructor */
 	void Construct(const FArguments& Args, TSharedPtr < FInputData >& );
 
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+
 	TSharedRef<ITableRow> OnGenerateRow(TSharedRef<FDifference> Item, const TSharedRef<STableViewBase>& OwnerTable);
 
+	TSharedRef<ITableRow> OnGenerateTreeRow(TSharedRef<FDifferenceTreeNode> Item, const TSharedRef<STableViewBase>& OwnerTable);
+
 
 private:
 
 	FReply OnCompareButtonClicked();
 
+	// copy the side A values of the selected rows to the vehicles selected in the content browser, or to vehicle B
+	FReply OnCopySelectedButtonClicked();
+
+	bool CanCopySelected() const;
+
+	// show new Results in the list and the tree
+	void RefreshResults();
+
+	// load the vehicles a little each frame with progress and cancel, then call OnFinished
+	void StartPreparation(const TArray<FString>& VehicleAssetPaths, FVehiclePreparation::FOnFinished OnFinished);
+
 private:
 	// input data
 	UPROPERTY()
@@ -38,11 +56,37 @@ private:
 	UPROPERTY()
 	TArray< TSharedRef< class FDifference > > Results;
 
+	// side A of the comparison which made Results, values are copied from it
+	FString ResultsSourceVehicle;
+
 	// results box in UI
 	TSharedPtr< SVerticalBox > VerticalBox;
 
 	// the list view
 	TSharedPtr< SListView< TSharedRef<FDifference> > > ListViewWidget;
 
+	// the same results as a tree of components, structs and arrays, children are made when a node is expanded
+	TSharedPtr< STreeView< TSharedRef<FDifferenceTreeNode> > > TreeViewWidget;
+
+	// top level of the tree
+	TArray< TSharedRef<FDifferenceTreeNode> > TreeRoots;
+
+	// show the tree instead of the list
+	bool bShowTree = false;
+
+	// footer with result count, row widget count and paint time, updated a few times a second
+	FText StatsText;
+	double StatsPaintSeconds = 0.0;
+	int32 StatsFrames = 0;
+	double StatsElapsedSeconds = 0.0;
+
+	// vehicles being loaded for a comparison or a copy, null when nothing is running
+	TSharedPtr< FVehiclePreparation > Preparation;
+	float PreparationProgress = 0.0f;
+	FText PreparationStatus;
+
+	// decides which blueprints the vehicle pickers show
+	FVehicleAssetFilter VehicleAssetFilter;
+
 };
 
@@ -0,0 +1,164 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "Difference.h"
+#include "PropertyFilter.h"
+
+class UCompareVehicleBlueprintsSettings;
+class FPropertyComparer;
+
+// receives what a comparison finds, in traversal order and always on the thread which started the comparison
+class COMPAREVEHICLEBLUEPRINTS_API IPropertyCompareSink
+{
+public:
+	virtual ~IPropertyCompareSink() = default;
+
+	virtual void OnDifference(const TSharedRef<FDifference>& Difference) = 0;
+};
+
+// appends to an array the caller owns
+class COMPAREVEHICLEBLUEPRINTS_API FDifferenceArraySink : public IPropertyCompareSink
+{
+public:
+	explicit FDifferenceArraySink(TArray<TSharedRef<FDifference>>& InResults) : Results(InResults) {}
+
+	virtual void OnDifference(const TSharedRef<FDifference>& Difference) override { Results.Add(Difference); }
+
+private:
+	TArray<TSharedRef<FDifference>>& Results;
+};
+
+// state for one traversal, parallel workers each have their own so results can be merged in order
+struct COMPAREVEHICLEBLUEPRINTS_API FPropertyCompareContext
+{
+	TArray<TSharedRef<FDifference>> Results;
+
+	// property names from the object down to the property being compared, tested against the filter.
+	// Pushed and popped for every property, deep enough for most paths without a heap allocation
+	TArray<FName, TInlineAllocator<16>> PropertyPath;
+
+	// element being compared for each array in PropertyPath, INDEX_NONE for everything else
+	TArray<int32, TInlineAllocator<16>> ArrayIndices;
+
+	// the side A component template, None when not comparing components
+	FName Component;
+
+	// PropertyPath with array indices as text
+	FString GetPropertyPathString() const;
+};
+
+// compares two objects, or two instances of a struct, property by property through reflection. Knows nothing
+// about vehicles, what it finds goes to a sink so any asset type can be diffed with the same traversal
+class COMPAREVEHICLEBLUEPRINTS_API FPropertyComparer
+{
+public:
+	// a comparison written for one struct type, used in place of the field by field traversal. Called from
+	// parallel workers so must not keep state of its own
+	using FStructComparer = void (*)(FPropertyComparer& Comparer, FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const FStructProperty* Property, const uint8* StructAddrA, const uint8* StructAddrB);
+
+	// the editable properties of a class and its default object, built once per class
+	struct FClassLayout
+	{
+		const UObject* Defaults = nullptr;
+		TArray<FProperty*> EditProperties;
+	};
+
+	FPropertyComparer();
+
+	// filter and parallel traversal from the project settings, until this is called nothing is filtered and the traversal is serial
+	void ApplySettings(const UCompareVehicleBlueprintsSettings& Settings);
+
+	// when true only properties which differ from the class defaults on at least one side are compared
+	void SetUseArchetypePrefilter(bool bInUseArchetypePrefilter) { bUseArchetypePrefilter = bInUseArchetypePrefilter; }
+	bool GetUseArchetypePrefilter() const { return bUseArchetypePrefilter; }
+
+	void RegisterStructComparer(const UScriptStruct* Struct, FStructComparer Comparer);
+
+	// compare the editable properties of two objects of (a subclass of) Class, except SkipProperty. Component is recorded
+	// on every difference so the value can be found on the blueprint again. Returns the number of properties which
+	// needed a full comparison
+	int32 CompareObjects(const FString& PathA, const FString& PathB, UClass* Class, const UObject* A, const UObject* B, IPropertyCompareSink& Sink,
+		FName Component = NAME_None, FName SkipProperty = NAME_None);
+
+	// compare two instances of Struct field by field
+	void CompareStructs(const FString& PathA, const FString& PathB, const UStruct* Struct, const void* A, const void* B, IPropertyCompareSink& Sink);
+
+	const FClassLayout& GetClassLayout(UClass* Class);
+
+	// forget the class layouts, display names and enum strings learned so far, for when classes may have changed
+	void FlushCaches();
+
+	// true if a class or struct the caches were built from has been garbage collected
+	bool HasStaleCaches() const;
+
+	// Path with the property's display name appended, cached per property. Safe to call from parallel workers
+	FString AppendDisplayName(const FString& Path, const FProperty* Property);
+
+	// an enum value as the editor shows it, cached per value. Safe to call from parallel workers
+	FString GetEnumValueString(const UEnum* Enum, int64 Value);
+
+	// for struct comparers, these recurse into the traversal and report through the context
+	void CompareProperty(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+
+	// a field a struct comparer found to differ, filtered and reported through reflection like any other
+	void CompareStructField(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, const UScriptStruct* Struct, FName FieldName, const uint8* StructAddrA, const uint8* StructAddrB);
+
+	void Report(FPropertyCompareContext& Context, FString PathA, FString PathB, const FString& Type, const FProperty* Property, const FString& StringValueA, const FString& StringValueB);
+	void AddMessage(FPropertyCompareContext& Context, const FString& Message, const EDifferenceType& Type);
+
+	// true if the include/exclude rules skip this property, and everything below it, at the current path
+	bool IsFilteredOut(FPropertyCompareContext& Context, const FProperty* Property) const;
+
+	// the same for a field of a struct being compared, so struct comparers can leave out summaries of filtered fields
+	bool IsStructFieldFilteredOut(FPropertyCompareContext& Context, const UScriptStruct* Struct, FName FieldName) const;
+
+private:
+	// compare the listed properties of two containers, in parallel when there is enough work. Results reach the
+	// sink in the order of Properties however the work is split
+	void CompareTopLevel(const FString& PathA, const FString& PathB, TConstArrayView<FProperty*> Properties, const void* A, const void* B, FName Component, IPropertyCompareSink& Sink);
+
+	// rough number of properties below a property, used to balance parallel work
+	int32 EstimateStaticSize(const FProperty* Property);
+	int32 EstimateSubtreeSize(const FProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+
+	// compare types of properties
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FEnumProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FBoolProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FNumericProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FStrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FClassProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FTextProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FNameProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FObjectPtrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FSoftObjectProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FStructProperty* StructProperty, const uint8* StructAddrA, const uint8* StructAddrB);
+	void Compare(FPropertyCompareContext& Context, const FString& PathA, const FString& PathB, FArrayProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+
+private:
+	TMap<const UScriptStruct*, FStructComparer> StructComparers;
+
+	// cached layouts of the compared classes
+	TMap<const UClass*, FClassLayout> ClassLayouts;
+
+	// cached results of EstimateStaticSize() for structs
+	TMap<const UStruct*, int32> StructSizes;
+
+	// classes and structs compared so far, everything cached is reachable from one of them
+	TSet<TWeakObjectPtr<const UStruct>> CacheRoots;
+
+	// written by parallel workers, under CacheLock
+	TMap<const FProperty*, FString> DisplayNames;
+	TMap<TPair<const UEnum*, int64>, FString> EnumValueStrings;
+	FRWLock CacheLock;
+
+	bool bUseArchetypePrefilter = true;
+
+	bool bParallelTraversal = false;
+	int32 MinParallelTraversalSize = 512;
+
+	// include/exclude rules
+	FPropertyFilter Filter;
+};
@@ -0,0 +1,70 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ComparisonMemory.h"
+
+class UCompareVehicleBlueprintsSettings;
+
+// include/exclude rules for the property traversal. The path globs are compiled into prefix tries
+// so a property is tested once before descent and excluded subtrees are never visited
+class COMPAREVEHICLEBLUEPRINTS_API FPropertyFilter
+{
+public:
+	void Compile(const UCompareVehicleBlueprintsSettings& Settings);
+
+	// Path is the property names from the component down to Property, array indices are not included
+	bool IsExcluded(TConstArrayView<FName> Path, const FProperty* Property) const;
+
+	bool IsEmpty() const;
+
+private:
+	// trie of path segments, a segment is a property name, a wildcard pattern or "**"
+	class FPathTrie
+	{
+	public:
+		enum class EMatch : uint8
+		{
+			// no rule can match this path or anything below it
+			None,
+			// a rule could match something below this path, only worth descending for structs, objects and arrays of them
+			Partial,
+			// a rule matches this path or one of its parents
+			Full
+		};
+
+		void Reset();
+		void Add(const FString& Pattern);
+		bool IsEmpty() const { return Nodes.Num() <= 1; }
+		EMatch Match(TConstArrayView<FName> Path) const;
+
+	private:
+		struct FNode
+		{
+			TMap<FName, int32> Children;
+			TArray<TPair<FString, int32>> WildcardChildren;
+			int32 AnyDepthChild = INDEX_NONE;
+			bool bIsAnyDepth = false;
+			bool bTerminal = false;
+		};
+
+		// add the nodes reachable without consuming a segment
+		void AddState(int32 Node, TScratchArray<int32>& States) const;
+
+		TArray<FNode> Nodes;
+	};
+
+	bool IsExcludedByFlags(const FProperty* Property) const;
+
+private:
+	FPathTrie Include;
+	FPathTrie Exclude;
+
+	TArray<FString> ExcludeCategories;
+	EPropertyFlags ExcludeFlags = CPF_None;
+
+	// category and flag checks only depend on the property, the cache is shared by parallel traversal workers
+	mutable TMap<const FProperty*, bool> ExcludedByFlags;
+	mutable FRWLock ExcludedByFlagsLock;
+};
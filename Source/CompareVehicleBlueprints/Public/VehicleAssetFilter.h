@@ -0,0 +1,26 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssetRegistry/AssetData.h"
+
+// decides whether an asset is a wheeled vehicle blueprint from its asset registry tags, so nothing is loaded.
+// Results for parent classes are cached, a project normally has only a handful of vehicle base classes
+class COMPAREVEHICLEBLUEPRINTS_API FVehicleAssetFilter
+{
+public:
+	// true if the asset is a blueprint deriving from AWheeledVehiclePawn
+	bool IsWheeledVehicleBlueprint(const FAssetData& AssetData);
+
+	// object paths of every wheeled vehicle blueprint under PackagePaths (all content when empty) whose asset
+	// name matches the NameFilter wildcard, sorted so batch runs are repeatable. Nothing is loaded
+	TArray<FString> FindWheeledVehicleBlueprints(const TArray<FString>& PackagePaths, const FString& NameFilter = "*");
+
+private:
+	// ClassPath is the object path of a native or blueprint generated class
+	bool IsWheeledVehicleClass(const FString& ClassPath, int32 Depth);
+
+	// cached results, class path -> derives from AWheeledVehiclePawn
+	TMap<FString, bool> ClassResults;
+};
@@ -7,8 +7,44 @@
 #include "AnimationGraph.h"
 
 #include "Difference.h"
+#include "VehicleSnapshot.h"
+#include "PropertyComparer.h"
 #include "VehicleCompareImpl.generated.h"
 
+class UBlueprint;
+class USkeletalMeshComponent;
+class UChaosWheeledVehicleMovementComponent;
+class UBlueprintGeneratedClass;
+class USCS_Node;
+
+// the components of one vehicle blueprint which take part in a comparison
+struct FVehicleComponents
+{
+	FString AssetPath;
+	UBlueprint* Blueprint = nullptr;
+
+	// component templates, with the variable name of each and the name of the component it is attached to (None at the root).
+	// A component inherited from a parent blueprint and not overridden is the parent's template, read only here
+	TArray< const UObject* > Subobjects;
+	TArray< FName > SubobjectNames;
+	TArray< FName > ParentNames;
+
+	TArray< const USkeletalMeshComponent* > SkeletalMeshComponents;
+	TArray< const UChaosWheeledVehicleMovementComponent* > VehicleMovementComponents;
+
+	// collect the component templates of a loaded blueprint straight from its class default object and construction scripts
+	void GatherComponents(UBlueprint* InBlueprint);
+
+	// sort a component template of the blueprint into the lists above
+	void AddSubobject(const UObject* Object, FName Name, FName ParentName);
+
+	// false if a template has been replaced since it was gathered, e.g. by compiling the blueprint
+	bool AreComponentsValid() const;
+
+private:
+	void AddConstructionNode(const USCS_Node* Node, FName ParentName, UBlueprintGeneratedClass* GeneratedClass);
+};
+
 /**
  * compare vehicle blueprints 
  */
@@ -18,14 +54,57 @@ class COMPAREVEHICLEBLUEPRINTS_API UVehicleCompareImpl: public UObject
 	GENERATED_BODY()
 
 public:
+	UVehicleCompareImpl();
+
 	void CompareVehicleBlueprints(const FString& VehicleAssetPath1, const FString& VehicleAssetPath2);
 
+	// compare two vehicles which are already loaded, e.g. by FVehiclePreparation
+	void CompareVehicleComponents(const FVehicleComponents& Vehicle1, const FVehicleComponents& Vehicle2);
+
+	// record the compared properties of one vehicle, returns false if the vehicle cannot be loaded
+	bool CaptureVehicleSnapshot(const FString& VehicleAssetPath, FVehicleSnapshot& OutSnapshot);
+
+	// compare a vehicle against a golden snapshot, differences with a path matching one of the
+	// AllowList wildcards are reported as info. Returns the number of differences not allowed
+	int32 CompareVehicleWithSnapshot(const FString& VehicleAssetPath, const FVehicleSnapshot& Snapshot, const TArray<FString>& AllowList);
+
+	// load a blueprint and find the components we compare, returns false if it cannot be loaded
+	bool LoadVehicleComponents(const FString& VehicleAssetPath, FVehicleComponents& OutComponents);
+
 	const TArray<TSharedRef< class FDifference >>& GetResults() const;
 
+	// hand the results so far to the caller, leaving none behind
+	TArray<TSharedRef<FDifference>> TakeResults() { return MoveTemp(Results); }
+
+	// forget the results so far, lets one object run many comparisons and keep its class layouts
+	void ResetResults() { Results.Reset(); }
+
+	// when true only properties which differ from the class defaults on at least one side are compared
+	void SetUseArchetypePrefilter(bool bInUseArchetypePrefilter) { PropertyComparer.SetUseArchetypePrefilter(bInUseArchetypePrefilter); }
+
+	// what the property traversal has learned about classes, see FPropertyComparer
+	void FlushCaches() { PropertyComparer.FlushCaches(); }
+	bool HasStaleCaches() const { return PropertyComparer.HasStaleCaches(); }
+
 private:
+	void CompareLoadedVehicles(const FVehicleComponents& Vehicle1, const FVehicleComponents& Vehicle2);
+
+	// compare the editable properties of two components of the same class
+	void CompareComponentProperties(const FString& PathA, const FString& PathB, UClass* Class, const UObject* A, const UObject* B);
+
 	void CompareVehicleMovementComponents( const FString& PathA, const FString& PathB, const class UChaosWheeledVehicleMovementComponent* A, const UChaosWheeledVehicleMovementComponent* B);
 	void CompareSkeletalMeshComponents( const FString& PathA, const FString& PathB, const class USkeletalMeshComponent* A, const USkeletalMeshComponent* B);
 
+	// compare bodies and constraints of two physics assets, joined on bone and joint names
+	void ComparePhysicsAssets(const FString& PathA, const FString& PathB, const class UPhysicsAsset* A, const UPhysicsAsset* B);
+	void CompareBodyGeometry(const FString& PathA, const FString& PathB, const struct FKAggregateGeom& A, const FKAggregateGeom& B);
+
+	// compare the bone hierarchies and reference poses of two meshes, bones are matched by name
+	void CompareSkeletons(const FString& PathA, const FString& PathB, const class USkeletalMesh* A, const USkeletalMesh* B);
+
+	// compare the editable properties of two objects, except SkipProperty
+	void CompareObjectProperties(const FString& PathA, const FString& PathB, UClass* Class, const UObject* A, const UObject* B, const FName SkipProperty = NAME_None);
+
 	// check the BP_Car->SkeletalMeshAsset->PhysicsAsset->BoneNames has wheel names for those names used in the ChaosWheeledVehicleMovementComponent->WheelSetup
 	void CheckWheelNames(const FString& Path, const USkeletalMeshComponent* SkeletalMeshComponent, const UChaosWheeledVehicleMovementComponent* VehicleMovementComponent);
 
@@ -34,21 +113,11 @@ private:
 	void AddWarning(const FString& Message);
 	void AddError(const FString& Message);
 	void AddInfo(const FString& Message);
-	void Report(FString PathA, FString PathB, const FString& Type, const FProperty* Property, const FString& StringValueA, const FString& StringValueB);
-
-	// compare types of properties
-	void CompareProperty(const FString& PathA, const FString& PathB, FProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FEnumProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FBoolProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FNumericProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FStrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FClassProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FTextProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FNameProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FObjectPtrProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FSoftObjectProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FStructProperty* StructProperty, const uint8* StructAddrA, const uint8* StructAddrB);
-	void Compare(const FString& PathA, const FString& PathB, FArrayProperty* Property, const uint8* PropertyAddrA, const uint8* PropertyAddrB);
+	void ReportValues(const FString& PathA, const FString& PathB, const FString& StringValueA, const FString& StringValueB);
+
+	// flatten properties into a snapshot
+	void CaptureComponent(const FString& Path, UClass* Class, const UObject* Component, FVehicleSnapshot& Snapshot);
+	void CaptureProperty(const FString& Path, FProperty* Property, const uint8* PropertyAddr, FVehicleSnapshot& Snapshot);
 
 
 private:
@@ -56,4 +125,11 @@ private:
 
 	// log differences
 	TArray<TSharedRef<FDifference>> Results;
+
+	// the property by property traversal, with the Chaos vehicle structs registered on it
+	FPropertyComparer PropertyComparer;
+
+	// component properties which needed a full comparison, and all of them, for the summary of one comparison
+	int32 NumPropertiesCompared = 0;
+	int32 NumPropertiesTotal = 0;
 };
@@ -0,0 +1,96 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "VehicleCompareLibrary.generated.h"
+
+// EDifferenceType for blueprints and python
+UENUM(BlueprintType)
+enum class EVehicleDifferenceType : uint8
+{
+	Info,
+	Error,
+	Warning,
+	Difference
+};
+
+// two vehicle blueprints to compare, as object paths such as /Game/Cars/BP_Car.BP_Car
+USTRUCT(BlueprintType)
+struct COMPAREVEHICLEBLUEPRINTS_API FVehicleBlueprintPair
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compare Vehicle Blueprints")
+	FString VehicleA;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Compare Vehicle Blueprints")
+	FString VehicleB;
+};
+
+// one line of comparison output. Differences have both paths and values, messages only have Message
+USTRUCT(BlueprintType)
+struct COMPAREVEHICLEBLUEPRINTS_API FVehicleDifferenceResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	EVehicleDifferenceType Type = EVehicleDifferenceType::Info;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	FString Message;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	FString PathA;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	FString PathB;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	FString ValueA;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	FString ValueB;
+};
+
+// everything one pair produced
+USTRUCT(BlueprintType)
+struct COMPAREVEHICLEBLUEPRINTS_API FVehicleComparisonResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	FVehicleBlueprintPair Pair;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	int32 NumDifferences = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	int32 NumErrors = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Compare Vehicle Blueprints")
+	TArray<FVehicleDifferenceResult> Results;
+};
+
+/**
+ * comparisons for editor scripts, e.g. from python:
+ *   pairs = [unreal.VehicleBlueprintPair(vehicle_a=a, vehicle_b=b) for a, b in cars]
+ *   for result in unreal.VehicleCompareLibrary.compare_vehicle_blueprint_pairs(pairs, False):
+ *       print(result.pair.vehicle_b, result.num_differences)
+ */
+UCLASS()
+class COMPAREVEHICLEBLUEPRINTS_API UVehicleCompareLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+	// compare every pair in one call, results are in the same order as the pairs. Info lines are left out unless bIncludeInfo
+	UFUNCTION(BlueprintCallable, Category = "Compare Vehicle Blueprints")
+	static TArray<FVehicleComparisonResult> CompareVehicleBlueprintPairs(const TArray<FVehicleBlueprintPair>& Pairs, bool bIncludeInfo = false);
+
+	// object paths of the wheeled vehicle blueprints under some content paths (everywhere when empty) with names matching a wildcard,
+	// found from asset registry tags without loading anything
+	UFUNCTION(BlueprintCallable, Category = "Compare Vehicle Blueprints")
+	static TArray<FString> FindWheeledVehicleBlueprints(const TArray<FString>& PackagePaths, const FString& NameFilter = TEXT("*"));
+};
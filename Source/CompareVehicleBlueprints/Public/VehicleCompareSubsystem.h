@@ -0,0 +1,50 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "Kismet2/EnumEditorUtils.h"
+#include "Difference.h"
+#include "VehicleCompareImpl.h"
+#include "VehicleCompareSubsystem.generated.h"
+
+/**
+ * keeps one comparer for the editor session, so class layouts, display names and enum strings learned by one comparison
+ * are still there for the next. The caches are flushed when a blueprint compiles, classes are reinstanced, a user
+ * defined enum is edited, or a class they were built from is garbage collected
+ */
+UCLASS()
+class COMPAREVEHICLEBLUEPRINTS_API UVehicleCompareSubsystem : public UEditorSubsystem, public FEnumEditorUtils::INotifyOnEnumChanged
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// compare two vehicles which are already loaded, the results are moved to the caller
+	TArray<TSharedRef<FDifference>> CompareVehicleComponents(const FVehicleComponents& Vehicle1, const FVehicleComponents& Vehicle2);
+
+	// load and compare two vehicle blueprints, the results are moved to the caller
+	TArray<TSharedRef<FDifference>> CompareVehicleBlueprints(const FString& VehicleAssetPath1, const FString& VehicleAssetPath2);
+
+	// forget everything learned about classes
+	void FlushCaches();
+
+	// FEnumEditorUtils::INotifyOnEnumChanged, renaming a value of a user defined enum changes the strings cached for it
+	virtual void PreChange(const UUserDefinedEnum* Changed, FEnumEditorUtils::EEnumEditorChangeInfo ChangedType) override {}
+	virtual void PostChange(const UUserDefinedEnum* Changed, FEnumEditorUtils::EEnumEditorChangeInfo ChangedType) override;
+
+private:
+	void OnBlueprintCompiled();
+	void OnObjectsReinstanced(const TMap<UObject*, UObject*>& ReplacementMap);
+	void OnPostGarbageCollect();
+
+	UPROPERTY()
+	TObjectPtr<UVehicleCompareImpl> Comparer;
+
+	FDelegateHandle BlueprintCompiledHandle;
+	FDelegateHandle ObjectsReinstancedHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+};
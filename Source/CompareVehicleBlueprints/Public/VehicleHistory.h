@@ -0,0 +1,83 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FVehicleSnapshot;
+
+// one property value changing between two revisions
+struct FVehicleHistoryChange
+{
+	// the revision the new value was saved in
+	int32 Revision = 0;
+	FDateTime Time;
+
+	FString Path;
+
+	// "(missing)" when the property did not exist on that side
+	FString OldValue;
+	FString NewValue;
+};
+
+// every saved revision of one vehicle's compared properties. A revision stores only the values which changed
+// since the one before it, and every few revisions a keyframe stores them all, so any revision can be rebuilt
+// by replaying from the keyframe before it without loading old packages
+class COMPAREVEHICLEBLUEPRINTS_API FVehicleHistory
+{
+public:
+	FVehicleHistory();
+
+	bool SaveToFile(const FString& FileName) const;
+	bool LoadFromFile(const FString& FileName);
+
+	// the history file for a vehicle under the project's Saved directory
+	static FString GetHistoryFile(const FString& VehicleAssetPath);
+
+	// capture the vehicle as it is now and append it to its history file
+	static bool RecordRevision(const FString& VehicleAssetPath);
+
+	// append a revision, returns its number or INDEX_NONE if no compared value changed since the last one
+	int32 AddRevision(const FVehicleSnapshot& Snapshot, const FDateTime& Time);
+
+	// newest revision number, INDEX_NONE when empty
+	int32 GetLatestRevision() const { return Revisions.Num() - 1; }
+
+	FDateTime GetRevisionTime(int32 Revision) const { return Revisions[Revision].Time; }
+
+	// rebuild all values as they were saved in Revision
+	bool GetValuesAt(int32 Revision, TMap<FString, FString>& OutValues) const;
+
+	// every value that differs between two revisions
+	bool GetChangesBetween(int32 FromRevision, int32 ToRevision, TArray<FVehicleHistoryChange>& OutChanges) const;
+
+	// every revision in which a property matching the wildcard changed, oldest first
+	TArray<FVehicleHistoryChange> FindChanges(const FString& PathWildcard) const;
+
+public:
+	// the asset the history was recorded from
+	FString VehicleAssetPath;
+
+	// store every value in one revision out of this many
+	int32 KeyframeInterval = 32;
+
+private:
+	struct FRevision
+	{
+		FDateTime Time;
+
+		// keyframes hold every value in Set and nothing in Removed
+		bool bKeyframe = false;
+
+		TMap<FString, FString> Set;
+		TArray<FString> Removed;
+	};
+
+	static void ApplyRevision(const FRevision& Revision, TMap<FString, FString>& InOutValues);
+
+private:
+	TArray<FRevision> Revisions;
+
+	// values as of the newest revision, what the next revision is a delta against
+	TMap<FString, FString> Head;
+};
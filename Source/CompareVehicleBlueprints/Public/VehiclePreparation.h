@@ -0,0 +1,84 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "UObject/GCObject.h"
+#include "Difference.h"
+#include "VehicleCompareImpl.h"
+
+// loads vehicle blueprints and gathers their components on the game thread a few steps at a time from the core ticker,
+// so preparing many vehicles never holds the editor for much longer than the frame budget in the project settings.
+// Packages are loaded asynchronously, then gathering the components of each vehicle is one short step
+class COMPAREVEHICLEBLUEPRINTS_API FVehiclePreparation : public FGCObject, public TSharedFromThis<FVehiclePreparation>
+{
+public:
+	// Progress is 0 to 1, Status says which vehicle is being worked on
+	using FOnProgress = TFunction<void(float Progress, const FString& Status)>;
+
+	// called once, after the last vehicle or after Cancel()
+	using FOnFinished = TFunction<void(FVehiclePreparation& Preparation)>;
+
+	static TSharedRef<FVehiclePreparation> Start(const TArray<FString>& VehicleAssetPaths, FOnProgress OnProgress, FOnFinished OnFinished);
+
+	virtual ~FVehiclePreparation();
+
+	// stops at the end of the current step, vehicles not prepared yet keep a null Blueprint
+	void Cancel();
+
+	bool IsCancelled() const { return bCancelled; }
+	bool IsFinished() const { return bFinished; }
+	float GetProgress() const;
+
+	// one entry per path passed to Start(), in the same order. Blueprint is null for vehicles which could not be loaded
+	const TArray<FVehicleComponents>& GetVehicles() const { return Vehicles; }
+
+	// errors for vehicles which could not be loaded
+	const TArray<TSharedRef<FDifference>>& GetMessages() const { return Messages; }
+
+	// FGCObject, the blueprints and gathered templates are not referenced by anything else between frames
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+
+private:
+	FVehiclePreparation(const TArray<FString>& VehicleAssetPaths, FOnProgress InOnProgress, FOnFinished InOnFinished);
+
+	bool Tick(float DeltaTime);
+
+	// does one step on the current vehicle, returns false when waiting for a package to load
+	bool Step();
+
+	void OnPackageLoaded(const FName& PackageName, UPackage* Package, EAsyncLoadingResult::Type Result);
+
+	void NextVehicle();
+	void Finish();
+
+	void AddError(const FString& Message);
+
+private:
+	enum class EStep : uint8
+	{
+		Load,
+		WaitForLoad,
+		Gather,
+	};
+
+	TArray<FString> VehicleAssetPaths;
+	TArray<FVehicleComponents> Vehicles;
+	TArray<TSharedRef<FDifference>> Messages;
+
+	FOnProgress OnProgress;
+	FOnFinished OnFinished;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	// the vehicle being prepared and what it is waiting on
+	int32 VehicleIndex = 0;
+	EStep CurrentStep = EStep::Load;
+
+	float FrameBudgetSeconds = 0.005f;
+
+	bool bCancelled = false;
+	bool bFinished = false;
+};
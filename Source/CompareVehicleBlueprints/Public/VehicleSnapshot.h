@@ -0,0 +1,21 @@
+// Copyright John Farrow (c) 2023. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// the compared properties of one vehicle flattened to text, used as a golden baseline so
+// later runs can check a vehicle without loading a second asset
+class COMPAREVEHICLEBLUEPRINTS_API FVehicleSnapshot
+{
+public:
+	bool SaveToFile(const FString& FileName) const;
+	bool LoadFromFile(const FString& FileName);
+
+public:
+	// the asset the snapshot was recorded from
+	FString VehicleAssetPath;
+
+	// property path such as "VehicleMovementComp.EngineSetup.MaxRPM" -> value exported as text, in traversal order
+	TMap<FString, FString> Values;
+};